@@ -0,0 +1,278 @@
+#include "AntiderivativeTanh.h"
+#include "SIMD.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace
+{
+// Tables cover |u| <= tableRange at tableResolution points per unit. Beyond
+// that tanh is 1 to within float precision and log (cosh (u)) is |u| - log 2.
+//
+// The antiderivative is stored as the residual G (u) = log (cosh (u)) - |u|,
+// which stays within [-log 2, 0]. Differencing F = |u| + G then cancels the
+// large linear part exactly, instead of losing it to float rounding when
+// |u| is large.
+constexpr int tableResolution = 64;
+constexpr float tableRange = 10.0f;
+constexpr int numIntervals = static_cast<int> (tableRange) * tableResolution;
+constexpr float intervalWidth = 1.0f / static_cast<float> (tableResolution);
+constexpr double log2 = 0.69314718055994530942;
+
+// Below this input step the ADAA quotient loses too much precision to float
+// cancellation, and the mean of the two tanh values is used instead.
+constexpr float illConditionedDelta = 1.0e-3f;
+
+// Shaped in chunks so the per-chunk scratch fits comfortably on the stack.
+constexpr int chunkSize = 64;
+
+// std::exp and std::log are not constexpr, so the table generator has its own.
+// x is at most 0 here: exp (x) = exp (x / 2^k)^(2^k), with the reduced
+// argument small enough for a short Taylor series.
+constexpr double constExp (double x)
+{
+    int squarings = 0;
+    while (x < -0.0625)
+    {
+        x *= 0.5;
+        ++squarings;
+    }
+
+    double sum = 1.0;
+    double term = 1.0;
+    for (int n = 1; n < 16; ++n)
+    {
+        term *= x / static_cast<double> (n);
+        sum += term;
+    }
+
+    for (int i = 0; i < squarings; ++i)
+        sum *= sum;
+
+    return sum;
+}
+
+// log (1 + y) for y in [0, 1], via 2 atanh (y / (2 + y)).
+constexpr double constLog1p (double y)
+{
+    const double z = y / (2.0 + y);
+    const double zSquared = z * z;
+    double power = z;
+    double sum = 0.0;
+
+    for (int n = 1; n < 80; n += 2)
+    {
+        sum += power / static_cast<double> (n);
+        power *= zSquared;
+    }
+
+    return 2.0 * sum;
+}
+
+struct Tables
+{
+    std::array<float, numIntervals + 1> tanh {};
+    std::array<float, numIntervals + 1> residual {};
+};
+
+// For u >= 0, with e = exp (-2u):
+//     tanh (u) = (1 - e) / (1 + e),  G (u) = log (1 + e) - log 2.
+constexpr Tables makeTables()
+{
+    Tables tables;
+
+    for (int i = 0; i <= numIntervals; ++i)
+    {
+        const double u = static_cast<double> (i) / static_cast<double> (tableResolution);
+        const double e = constExp (-2.0 * u);
+        tables.tanh[static_cast<size_t> (i)] = static_cast<float> ((1.0 - e) / (1.0 + e));
+        tables.residual[static_cast<size_t> (i)] = static_cast<float> (constLog1p (e) - log2);
+    }
+
+    return tables;
+}
+
+constexpr Tables tables = makeTables();
+
+// Position of |u| in the tables, shared by the scalar and SIMD lookups.
+struct TablePosition
+{
+    int index;
+    float fraction;
+    float sign;
+};
+
+inline TablePosition locate (float u) noexcept
+{
+    const auto magnitude = std::abs (u);
+    const auto position = std::min (magnitude, tableRange) * static_cast<float> (tableResolution);
+    const auto index = std::min (static_cast<int> (position), numIntervals - 1);
+    return { index, position - static_cast<float> (index), u < 0.0f ? -1.0f : 1.0f };
+}
+
+// Cubic Hermite interpolation. The slopes are exact: tanh' = 1 - tanh^2 and
+// G' = tanh - 1, so both curves are accurate to around 1e-9 between points.
+inline void lookup (float u, float& outTanh, float& outResidual) noexcept
+{
+    const auto p = locate (u);
+    const auto t0 = tables.tanh[static_cast<size_t> (p.index)];
+    const auto t1 = tables.tanh[static_cast<size_t> (p.index + 1)];
+    const auto g0 = tables.residual[static_cast<size_t> (p.index)];
+    const auto g1 = tables.residual[static_cast<size_t> (p.index + 1)];
+
+    const auto x = p.fraction;
+    const auto h00 = (2.0f * x - 3.0f) * x * x + 1.0f;
+    const auto h10 = ((x - 2.0f) * x + 1.0f) * x;
+    const auto h01 = (3.0f - 2.0f * x) * x * x;
+    const auto h11 = (x - 1.0f) * x * x;
+
+    const auto tanhMagnitude = h00 * t0 + h01 * t1 + intervalWidth * (h10 * (1.0f - t0 * t0) + h11 * (1.0f - t1 * t1));
+    outTanh = p.sign * tanhMagnitude;
+    outResidual = h00 * g0 + h01 * g1 + intervalWidth * (h10 * (t0 - 1.0f) + h11 * (t1 - 1.0f));
+}
+
+// Four lookups at once: the table reads are scalar (there is no gather before
+// AVX2), the interpolation is vectorised.
+inline void lookup4 (const float* u, float* outTanh, float* outResidual) noexcept
+{
+    float t0[simd::width], t1[simd::width], g0[simd::width], g1[simd::width];
+    float fractions[simd::width], signs[simd::width];
+
+    for (int lane = 0; lane < simd::width; ++lane)
+    {
+        const auto p = locate (u[lane]);
+        t0[lane] = tables.tanh[static_cast<size_t> (p.index)];
+        t1[lane] = tables.tanh[static_cast<size_t> (p.index + 1)];
+        g0[lane] = tables.residual[static_cast<size_t> (p.index)];
+        g1[lane] = tables.residual[static_cast<size_t> (p.index + 1)];
+        fractions[lane] = p.fraction;
+        signs[lane] = p.sign;
+    }
+
+    const auto one = simd::broadcast (1.0f);
+    const auto two = simd::broadcast (2.0f);
+    const auto three = simd::broadcast (3.0f);
+    const auto width = simd::broadcast (intervalWidth);
+
+    const auto x = simd::load (fractions);
+    const auto xx = simd::mul (x, x);
+    const auto h00 = simd::add (simd::mul (simd::sub (simd::mul (two, x), three), xx), one);
+    const auto h10 = simd::mul (simd::add (simd::mul (simd::sub (x, two), x), one), x);
+    const auto h01 = simd::mul (simd::sub (three, simd::mul (two, x)), xx);
+    const auto h11 = simd::mul (simd::sub (x, one), xx);
+
+    const auto vt0 = simd::load (t0);
+    const auto vt1 = simd::load (t1);
+    const auto slope0 = simd::sub (one, simd::mul (vt0, vt0));
+    const auto slope1 = simd::sub (one, simd::mul (vt1, vt1));
+
+    const auto tanhMagnitude = simd::add (simd::add (simd::mul (h00, vt0), simd::mul (h01, vt1)),
+                                          simd::mul (width, simd::add (simd::mul (h10, slope0), simd::mul (h11, slope1))));
+    simd::store (outTanh, simd::mul (simd::load (signs), tanhMagnitude));
+
+    const auto residual = simd::add (simd::add (simd::mul (h00, simd::load (g0)), simd::mul (h01, simd::load (g1))),
+                                     simd::mul (width, simd::add (simd::mul (h10, simd::sub (vt0, one)),
+                                                                  simd::mul (h11, simd::sub (vt1, one)))));
+    simd::store (outResidual, residual);
+}
+
+inline float antialiased (float u, float previousU, float t, float previousT, float g, float previousG) noexcept
+{
+    const auto delta = u - previousU;
+    if (std::abs (delta) < illConditionedDelta)
+        return 0.5f * (t + previousT);
+
+    return ((std::abs (u) - std::abs (previousU)) + (g - previousG)) / delta;
+}
+} // namespace
+
+float AntiderivativeTanh::tanh (float u) noexcept
+{
+    float t = 0.0f, f = 0.0f;
+    lookup (u, t, f);
+    return t;
+}
+
+float AntiderivativeTanh::logCosh (float u) noexcept
+{
+    float t = 0.0f, g = 0.0f;
+    lookup (u, t, g);
+    return std::abs (u) + g;
+}
+
+void AntiderivativeTanh::prepare (int maxChannels)
+{
+    previousInputs.assign (static_cast<size_t> (std::max (maxChannels, 0)), 0.0f);
+}
+
+void AntiderivativeTanh::reset() noexcept
+{
+    std::fill (previousInputs.begin(), previousInputs.end(), 0.0f);
+}
+
+void AntiderivativeTanh::process (int channel, float* samples, int numSamples,
+                                  const float* gainRamp, float gain, int gainRampShift) noexcept
+{
+    // Slot 0 of each scratch array holds the sample before the chunk, so the
+    // second pass reads u[n] and u[n-1] as two overlapping vectors.
+    float u[chunkSize + 1];
+    float t[chunkSize + 1];
+    float g[chunkSize + 1];
+
+    auto& previous = previousInputs[static_cast<size_t> (channel)];
+
+    for (int start = 0; start < numSamples; start += chunkSize)
+    {
+        const auto length = std::min (chunkSize, numSamples - start);
+        auto* block = samples + start;
+
+        u[0] = previous;
+        lookup (previous, t[0], g[0]);
+
+        int i = 0;
+        for (; i + simd::width <= length; i += simd::width)
+        {
+            const auto gains = gainRamp == nullptr
+                                 ? simd::broadcast (gain)
+                                 : simd::make (gainRamp[(start + i) >> gainRampShift],
+                                               gainRamp[(start + i + 1) >> gainRampShift],
+                                               gainRamp[(start + i + 2) >> gainRampShift],
+                                               gainRamp[(start + i + 3) >> gainRampShift]);
+
+            simd::store (u + 1 + i, simd::mul (gains, simd::load (block + i)));
+            lookup4 (u + 1 + i, t + 1 + i, g + 1 + i);
+        }
+
+        for (; i < length; ++i)
+        {
+            const auto sampleGain = gainRamp == nullptr ? gain : gainRamp[(start + i) >> gainRampShift];
+            u[1 + i] = sampleGain * block[i];
+            lookup (u[1 + i], t[1 + i], g[1 + i]);
+        }
+
+        const auto half = simd::broadcast (0.5f);
+        const auto threshold = simd::broadcast (illConditionedDelta);
+
+        i = 0;
+        for (; i + simd::width <= length; i += simd::width)
+        {
+            const auto current = simd::load (u + 1 + i);
+            const auto before = simd::load (u + i);
+            const auto delta = simd::sub (current, before);
+            const auto difference = simd::add (simd::sub (simd::abs (current), simd::abs (before)),
+                                               simd::sub (simd::load (g + 1 + i), simd::load (g + i)));
+            const auto quotient = simd::div (difference, delta);
+            const auto mean = simd::mul (half, simd::add (simd::load (t + 1 + i), simd::load (t + i)));
+
+            // The quotient lanes this discards may be inf or NaN; select() is
+            // bitwise, so they never reach the output.
+            simd::store (block + i, simd::select (simd::lessThan (simd::abs (delta), threshold), mean, quotient));
+        }
+
+        for (; i < length; ++i)
+            block[i] = antialiased (u[1 + i], u[i], t[1 + i], t[i], g[1 + i], g[i]);
+
+        previous = u[length];
+    }
+}
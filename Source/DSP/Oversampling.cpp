@@ -0,0 +1,471 @@
+#include "Oversampling.h"
+#include "SIMD.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+constexpr double pi = 3.14159265358979323846;
+
+// Zeroth-order modified Bessel function of the first kind, for the Kaiser window.
+double besselI0 (double x)
+{
+    double sum = 1.0;
+    double term = 1.0;
+
+    for (int k = 1; k < 64; ++k)
+    {
+        const double factor = x / (2.0 * static_cast<double> (k));
+        term *= factor * factor;
+        sum += term;
+
+        if (term < sum * 1.0e-12)
+            break;
+    }
+
+    return sum;
+}
+
+// Elliptic-function series used by the polyphase IIR halfband design
+// (Valenzuela & Constantinides, as popularised by Laurent de Soras' HIIR).
+double ellipticNumerator (double q, int order, int index)
+{
+    double result = 0.0;
+    double sign = 1.0;
+
+    for (int i = 0; i < 64; ++i)
+    {
+        const double term = std::pow (q, static_cast<double> (i * (i + 1)))
+                          * std::sin (static_cast<double> ((2 * i + 1) * index) * pi / static_cast<double> (order)) * sign;
+        result += term;
+        sign = -sign;
+
+        if (std::abs (term) < 1.0e-30)
+            break;
+    }
+
+    return result;
+}
+
+double ellipticDenominator (double q, int order, int index)
+{
+    double result = 0.0;
+    double sign = -1.0;
+
+    for (int i = 1; i < 64; ++i)
+    {
+        const double term = std::pow (q, static_cast<double> (i * i))
+                          * std::cos (static_cast<double> (2 * i * index) * pi / static_cast<double> (order)) * sign;
+        result += term;
+        sign = -sign;
+
+        if (std::abs (term) < 1.0e-30)
+            break;
+    }
+
+    return result;
+}
+} // namespace
+
+//==============================================================================
+// h[k] for k = -centre..centre is a Kaiser-windowed halfband sinc: h[0] = 0.5
+// and every other even tap is zero, so only the odd taps are stored, as
+// coefficients[q] = h[2q - centre]. The response is symmetric, which makes
+// that table its own reverse.
+void Oversampling::FirHalfband::design (int newHalfLength, double kaiserBeta)
+{
+    halfLength = newHalfLength;
+    centre = 2 * halfLength - 1;
+    coefficients.assign (static_cast<size_t> (2 * halfLength), 0.0f);
+
+    std::vector<double> taps (coefficients.size());
+    double sum = 0.0;
+
+    for (int q = 0; q < 2 * halfLength; ++q)
+    {
+        const double k = static_cast<double> (2 * q - centre);
+        const double ratio = k / static_cast<double> (centre + 1);
+        const double window = besselI0 (kaiserBeta * std::sqrt (1.0 - ratio * ratio)) / besselI0 (kaiserBeta);
+        taps[static_cast<size_t> (q)] = std::sin (pi * k / 2.0) / (pi * k) * window;
+        sum += taps[static_cast<size_t> (q)];
+    }
+
+    // The odd taps of a unity-gain halfband sum to exactly one half.
+    for (size_t q = 0; q < taps.size(); ++q)
+        coefficients[q] = static_cast<float> (0.5 * taps[q] / sum);
+}
+
+void Oversampling::FirHalfband::prepare (int maxChannels, int maxInputSamples)
+{
+    stride = 2 * halfLength + maxInputSamples;
+    upHistory.assign (static_cast<size_t> (maxChannels * stride), 0.0f);
+    downEvenHistory.assign (upHistory.size(), 0.0f);
+    downOddHistory.assign (upHistory.size(), 0.0f);
+}
+
+void Oversampling::FirHalfband::reset() noexcept
+{
+    std::fill (upHistory.begin(), upHistory.end(), 0.0f);
+    std::fill (downEvenHistory.begin(), downEvenHistory.end(), 0.0f);
+    std::fill (downOddHistory.begin(), downOddHistory.end(), 0.0f);
+}
+
+// Each history buffer holds the last (taps - 1) inputs followed by the new
+// block, so the dot products below read one contiguous window per output and
+// four outputs are computed per SIMD pass.
+void Oversampling::FirHalfband::upsample (int channel, const float* input, float* output, int numInputSamples) noexcept
+{
+    const int numTaps = 2 * halfLength;
+    const int history = numTaps - 1;
+    auto* window = upHistory.data() + channel * stride;
+    const auto* taps = coefficients.data();
+
+    std::copy (input, input + numInputSamples, window + history);
+
+    int i = 0;
+    for (; i + simd::width <= numInputSamples; i += simd::width)
+    {
+        auto sum = simd::broadcast (0.0f);
+        for (int q = 0; q < numTaps; ++q)
+            sum = simd::add (sum, simd::mul (simd::broadcast (taps[q]), simd::load (window + i + q)));
+
+        float even[simd::width];
+        simd::store (even, simd::add (sum, sum));
+
+        for (int lane = 0; lane < simd::width; ++lane)
+        {
+            output[2 * (i + lane)] = even[lane];
+            output[2 * (i + lane) + 1] = window[i + lane + halfLength];
+        }
+    }
+
+    for (; i < numInputSamples; ++i)
+    {
+        float sum = 0.0f;
+        for (int q = 0; q < numTaps; ++q)
+            sum += taps[q] * window[i + q];
+
+        output[2 * i] = 2.0f * sum;
+        output[2 * i + 1] = window[i + halfLength];
+    }
+
+    std::copy (window + numInputSamples, window + numInputSamples + history, window);
+}
+
+void Oversampling::FirHalfband::downsample (int channel, const float* input, float* output, int numOutputSamples) noexcept
+{
+    const int numTaps = 2 * halfLength;
+    const int history = numTaps - 1;
+    auto* even = downEvenHistory.data() + channel * stride;
+    auto* odd = downOddHistory.data() + channel * stride;
+    const auto* taps = coefficients.data();
+
+    for (int i = 0; i < numOutputSamples; ++i)
+    {
+        even[history + i] = input[2 * i];
+        odd[halfLength + i] = input[2 * i + 1];
+    }
+
+    const auto half = simd::broadcast (0.5f);
+
+    int i = 0;
+    for (; i + simd::width <= numOutputSamples; i += simd::width)
+    {
+        auto sum = simd::mul (half, simd::load (odd + i));
+        for (int q = 0; q < numTaps; ++q)
+            sum = simd::add (sum, simd::mul (simd::broadcast (taps[q]), simd::load (even + i + q)));
+
+        simd::store (output + i, sum);
+    }
+
+    for (; i < numOutputSamples; ++i)
+    {
+        float sum = 0.5f * odd[i];
+        for (int q = 0; q < numTaps; ++q)
+            sum += taps[q] * even[i + q];
+
+        output[i] = sum;
+    }
+
+    std::copy (even + numOutputSamples, even + numOutputSamples + history, even);
+    std::copy (odd + numOutputSamples, odd + numOutputSamples + halfLength, odd);
+}
+
+//==============================================================================
+// Two parallel chains of first-order allpasses running at the low rate; even
+// coefficients form one branch and odd coefficients the other.
+void Oversampling::IirHalfband::design (int newNumCoefficients, double transitionBandwidth)
+{
+    numCoefficients = newNumCoefficients;
+    coefficients.assign (static_cast<size_t> (numCoefficients), 0.0f);
+
+    double k = std::tan ((1.0 - 2.0 * transitionBandwidth) * pi / 4.0);
+    k *= k;
+    const double kkSqrt = std::pow (1.0 - k * k, 0.25);
+    const double e = 0.5 * (1.0 - kkSqrt) / (1.0 + kkSqrt);
+    const double e4 = e * e * e * e;
+    const double q = e * (1.0 + e4 * (2.0 + e4 * (15.0 + 150.0 * e4)));
+    const int order = 2 * numCoefficients + 1;
+
+    double branchDelays[2] = { 0.0, 0.0 };
+    double largestCoefficient = 0.0;
+
+    for (int index = 0; index < numCoefficients; ++index)
+    {
+        const double numerator = ellipticNumerator (q, order, index + 1) * std::pow (q, 0.25);
+        const double denominator = ellipticDenominator (q, order, index + 1) + 0.5;
+        const double ww = numerator / denominator;
+        const double wwSquared = ww * ww;
+        const double x = std::sqrt ((1.0 - wwSquared * k) * (1.0 - wwSquared / k)) / (1.0 + wwSquared);
+        const double coefficient = (1.0 - x) / (1.0 + x);
+
+        coefficients[static_cast<size_t> (index)] = static_cast<float> (coefficient);
+        branchDelays[index & 1] += (1.0 - coefficient) / (1.0 + coefficient);
+        largestCoefficient = std::max (largestCoefficient, coefficient);
+    }
+
+    // Each branch delays DC by the sum of its sections' delays at the low rate.
+    // The half-sample offsets from interleaving the branches cancel between the
+    // up and down filters, which otherwise contribute equally.
+    latency = 2.0 * (branchDelays[0] + branchDelays[1]);
+
+    // Each section has a pole at -coefficient per low-rate sample; the slowest
+    // one sets how long the up and down filters each take to fall by 120 dB.
+    decaySamples = largestCoefficient > 0.0 ? 2.0 * std::log (1.0e-6) / std::log (largestCoefficient) : 0.0;
+}
+
+void Oversampling::IirHalfband::prepare (int maxChannels)
+{
+    upState.assign (static_cast<size_t> (maxChannels * 2 * numCoefficients), 0.0f);
+    downState.assign (upState.size(), 0.0f);
+}
+
+void Oversampling::IirHalfband::reset() noexcept
+{
+    std::fill (upState.begin(), upState.end(), 0.0f);
+    std::fill (downState.begin(), downState.end(), 0.0f);
+}
+
+void Oversampling::IirHalfband::upsample (int channel, const float* input, float* output, int numInputSamples) noexcept
+{
+    auto* x = upState.data() + channel * 2 * numCoefficients;
+    auto* y = x + numCoefficients;
+    const auto* c = coefficients.data();
+
+    for (int i = 0; i < numInputSamples; ++i)
+    {
+        float branch[2] = { input[i], input[i] };
+
+        for (int k = 0; k < numCoefficients; ++k)
+        {
+            auto& sample = branch[k & 1];
+            const auto previousInput = x[k];
+            x[k] = sample;
+            sample = (sample - y[k]) * c[k] + previousInput;
+            y[k] = sample;
+        }
+
+        output[2 * i] = branch[0];
+        output[2 * i + 1] = branch[1];
+    }
+}
+
+void Oversampling::IirHalfband::downsample (int channel, const float* input, float* output, int numOutputSamples) noexcept
+{
+    auto* x = downState.data() + channel * 2 * numCoefficients;
+    auto* y = x + numCoefficients;
+    const auto* c = coefficients.data();
+
+    for (int i = 0; i < numOutputSamples; ++i)
+    {
+        float branch[2] = { input[2 * i + 1], input[2 * i] };
+
+        for (int k = 0; k < numCoefficients; ++k)
+        {
+            auto& sample = branch[k & 1];
+            const auto previousInput = x[k];
+            x[k] = sample;
+            sample = (sample - y[k]) * c[k] + previousInput;
+            y[k] = sample;
+        }
+
+        output[i] = 0.5f * (branch[0] + branch[1]);
+    }
+}
+
+//==============================================================================
+Oversampling::Oversampling()
+{
+    // The first stage carries the audible band, so it gets the steepest
+    // filters; later stages only have to reject images far above it. The
+    // designs don't depend on the sample rate, so they are fixed from here on.
+    static constexpr int firHalfLengths[maxFactorLog2] = { 48, 16, 8 };
+    static constexpr int iirCoefficients[maxFactorLog2] = { 10, 6, 4 };
+    static constexpr double iirTransitions[maxFactorLog2] = { 0.04, 0.15, 0.25 };
+
+    for (int stage = 0; stage < maxFactorLog2; ++stage)
+    {
+        firStages[stage].design (firHalfLengths[stage], 8.0);
+        iirStages[stage].design (iirCoefficients[stage], iirTransitions[stage]);
+    }
+}
+
+void Oversampling::prepare (int newMaxChannels, int newMaxBlockSize)
+{
+    maxChannels = std::max (newMaxChannels, 0);
+    maxBlockSize = std::max (newMaxBlockSize, 0);
+
+    for (int stage = 0; stage < maxFactorLog2; ++stage)
+    {
+        firStages[stage].prepare (maxChannels, maxBlockSize << stage);
+        iirStages[stage].prepare (maxChannels);
+    }
+
+    for (int level = 1; level <= maxFactorLog2; ++level)
+    {
+        const int levelSize = maxBlockSize << level;
+        levelStorage[level].assign (static_cast<size_t> (maxChannels * levelSize), 0.0f);
+        levelPointers[level].resize (static_cast<size_t> (maxChannels));
+
+        for (int channel = 0; channel < maxChannels; ++channel)
+            levelPointers[level][static_cast<size_t> (channel)] = levelStorage[level].data() + channel * levelSize;
+    }
+
+    padStorage.assign (static_cast<size_t> (maxChannels << maxFactorLog2), 0.0f);
+    padPositions.assign (static_cast<size_t> (maxChannels), 0);
+
+    updateLatency();
+    reset();
+}
+
+void Oversampling::reset() noexcept
+{
+    for (int stage = 0; stage < maxFactorLog2; ++stage)
+    {
+        firStages[stage].reset();
+        iirStages[stage].reset();
+    }
+
+    std::fill (padStorage.begin(), padStorage.end(), 0.0f);
+    std::fill (padPositions.begin(), padPositions.end(), 0);
+}
+
+void Oversampling::setMode (int newFactorLog2, FilterType newFilterType) noexcept
+{
+    newFactorLog2 = std::clamp (newFactorLog2, 0, maxFactorLog2);
+
+    if (newFactorLog2 == factorLog2 && newFilterType == filterType)
+        return;
+
+    factorLog2 = newFactorLog2;
+    filterType = newFilterType;
+    updateLatency();
+    reset();
+}
+
+Oversampling::Timing Oversampling::getTiming (int newFactorLog2, FilterType newFilterType) const noexcept
+{
+    Timing timing;
+    newFactorLog2 = std::clamp (newFactorLog2, 0, maxFactorLog2);
+
+    if (newFactorLog2 == 0)
+        return timing;
+
+    // Stage s runs between 2^s and 2^(s+1) times the base rate; its latency is
+    // measured in samples of the higher of the two.
+    if (newFilterType == FilterType::linearPhase)
+    {
+        int topRateLatency = 0;
+        for (int stage = 0; stage < newFactorLog2; ++stage)
+            topRateLatency += firStages[stage].getLatency() << (newFactorLog2 - stage - 1);
+
+        const int factor = 1 << newFactorLog2;
+        timing.padSamples = (factor - topRateLatency % factor) % factor;
+        timing.latencySamples = (topRateLatency + timing.padSamples) >> newFactorLog2;
+
+        // Every stage's up and down filters are symmetric about their delay,
+        // so the whole impulse response spans twice the latency.
+        timing.tailSamples = 2 * timing.latencySamples + 1;
+    }
+    else
+    {
+        double latency = 0.0;
+        double decay = 0.0;
+        for (int stage = 0; stage < newFactorLog2; ++stage)
+        {
+            latency += iirStages[stage].getLatency() / static_cast<double> (2 << stage);
+            decay += iirStages[stage].getDecaySamples() / static_cast<double> (1 << stage);
+        }
+
+        timing.latencySamples = static_cast<int> (std::lround (latency));
+        timing.tailSamples = static_cast<int> (std::ceil (decay));
+    }
+
+    return timing;
+}
+
+int Oversampling::getLatencySamples (int newFactorLog2, FilterType newFilterType) const noexcept
+{
+    return getTiming (newFactorLog2, newFilterType).latencySamples;
+}
+
+void Oversampling::updateLatency() noexcept
+{
+    const auto timing = getTiming (factorLog2, filterType);
+    latencySamples = timing.latencySamples;
+    tailSamples = timing.tailSamples;
+    padSamples = timing.padSamples;
+}
+
+float* const* Oversampling::processUp (const float* const* input, int numChannels, int numSamples) noexcept
+{
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        const auto* source = input[channel];
+
+        for (int stage = 0; stage < factorLog2; ++stage)
+        {
+            auto* dest = levelPointers[stage + 1][static_cast<size_t> (channel)];
+
+            if (filterType == FilterType::linearPhase)
+                firStages[stage].upsample (channel, source, dest, numSamples << stage);
+            else
+                iirStages[stage].upsample (channel, source, dest, numSamples << stage);
+
+            source = dest;
+        }
+
+        if (padSamples > 0)
+        {
+            auto* samples = levelPointers[factorLog2][static_cast<size_t> (channel)];
+            auto* ring = padStorage.data() + (channel << maxFactorLog2);
+            auto& position = padPositions[static_cast<size_t> (channel)];
+
+            for (int i = 0; i < (numSamples << factorLog2); ++i)
+            {
+                std::swap (samples[i], ring[position]);
+                position = position + 1 < padSamples ? position + 1 : 0;
+            }
+        }
+    }
+
+    return levelPointers[factorLog2].data();
+}
+
+void Oversampling::processDown (float* const* output, int numChannels, int numSamples) noexcept
+{
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        for (int stage = factorLog2 - 1; stage >= 0; --stage)
+        {
+            const auto* source = levelPointers[stage + 1][static_cast<size_t> (channel)];
+            auto* dest = stage > 0 ? levelPointers[stage][static_cast<size_t> (channel)] : output[channel];
+
+            if (filterType == FilterType::linearPhase)
+                firStages[stage].downsample (channel, source, dest, numSamples << stage);
+            else
+                iirStages[stage].downsample (channel, source, dest, numSamples << stage);
+        }
+    }
+}
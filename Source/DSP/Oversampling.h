@@ -0,0 +1,128 @@
+#pragma once
+
+#include <vector>
+
+// Polyphase 2x/4x/8x oversampling built from cascaded halfband stages, with
+// either linear-phase FIR halfbands or low-latency IIR (allpass pair)
+// halfbands. The filters are designed on construction; prepare() allocates
+// for the largest factor and both filter types, so setMode() can switch
+// between any of them on the audio thread.
+class Oversampling
+{
+public:
+    enum class FilterType
+    {
+        iir,
+        linearPhase
+    };
+
+    static constexpr int maxFactorLog2 = 3;
+
+    Oversampling();
+
+    void prepare (int maxChannels, int maxBlockSize);
+    void reset() noexcept;
+
+    // Never allocates. Changing the mode clears the filter state.
+    void setMode (int newFactorLog2, FilterType newFilterType) noexcept;
+
+    int getFactor() const noexcept { return 1 << factorLog2; }
+    int getFactorLog2() const noexcept { return factorLog2; }
+    FilterType getFilterType() const noexcept { return filterType; }
+
+    // Round-trip (up + down) latency in samples at the base rate. Linear-phase
+    // modes pad internally so this is exact; IIR modes report the rounded
+    // group delay at DC.
+    int getLatencySamples() const noexcept { return latencySamples; }
+
+    // The latency the given mode would report, without switching to it. Only
+    // reads the filter designs, so it can be called from any thread, even
+    // while another one processes or prepares.
+    int getLatencySamples (int newFactorLog2, FilterType newFilterType) const noexcept;
+
+    // How long, in base-rate samples, the output can still be non-silent after
+    // the input stops: the full impulse response for linear-phase modes, and
+    // the time for the slowest pole to decay by 120 dB for IIR modes.
+    int getTailSamples() const noexcept { return tailSamples; }
+
+    // Upsamples numSamples samples of each channel (at most the prepared block
+    // size) and returns the oversampled channels, numSamples * getFactor()
+    // samples each. Only valid when the factor is above 1.
+    float* const* processUp (const float* const* input, int numChannels, int numSamples) noexcept;
+
+    // Downsamples the buffers returned by the last processUp() into output.
+    void processDown (float* const* output, int numChannels, int numSamples) noexcept;
+
+private:
+    class FirHalfband
+    {
+    public:
+        void design (int halfLength, double kaiserBeta);
+        void prepare (int maxChannels, int maxInputSamples);
+        void reset() noexcept;
+        int getLatency() const noexcept { return 2 * centre; }
+
+        void upsample (int channel, const float* input, float* output, int numInputSamples) noexcept;
+        void downsample (int channel, const float* input, float* output, int numOutputSamples) noexcept;
+
+    private:
+        int halfLength = 0;
+        int centre = 0;
+        std::vector<float> coefficients;
+        int stride = 0;
+        std::vector<float> upHistory;
+        std::vector<float> downEvenHistory;
+        std::vector<float> downOddHistory;
+    };
+
+    class IirHalfband
+    {
+    public:
+        void design (int numCoefficients, double transitionBandwidth);
+        void prepare (int maxChannels);
+        void reset() noexcept;
+        double getLatency() const noexcept { return latency; }
+        double getDecaySamples() const noexcept { return decaySamples; }
+
+        void upsample (int channel, const float* input, float* output, int numInputSamples) noexcept;
+        void downsample (int channel, const float* input, float* output, int numOutputSamples) noexcept;
+
+    private:
+        int numCoefficients = 0;
+        double latency = 0.0;
+        double decaySamples = 0.0;
+        std::vector<float> coefficients;
+        std::vector<float> upState;
+        std::vector<float> downState;
+    };
+
+    struct Timing
+    {
+        int latencySamples = 0;
+        int tailSamples = 0;
+        int padSamples = 0;
+    };
+
+    Timing getTiming (int newFactorLog2, FilterType newFilterType) const noexcept;
+    void updateLatency() noexcept;
+
+    int factorLog2 = 0;
+    FilterType filterType = FilterType::linearPhase;
+    int latencySamples = 0;
+    int tailSamples = 0;
+    int maxChannels = 0;
+    int maxBlockSize = 0;
+
+    FirHalfband firStages[maxFactorLog2];
+    IirHalfband iirStages[maxFactorLog2];
+
+    // levels[l] holds the signal at 2^l times the base rate, one buffer per channel.
+    std::vector<float> levelStorage[maxFactorLog2 + 1];
+    std::vector<float*> levelPointers[maxFactorLog2 + 1];
+
+    // Linear-phase modes delay the top level by this many samples so the
+    // total latency is a whole number of base-rate samples.
+    int padSamples = 0;
+    std::vector<float> padStorage;
+    std::vector<int> padPositions;
+};
@@ -0,0 +1,96 @@
+#include "ParameterSmoother.h"
+#include "SIMD.h"
+
+#include <algorithm>
+#include <cmath>
+
+void ParameterSmoother::prepare (double sampleRate, double rampSeconds, int maximumBlockSize, Type newType)
+{
+    type = newType;
+    rampLengthSamples = std::max (0, static_cast<int> (std::floor (rampSeconds * sampleRate)));
+    ramp.assign (static_cast<size_t> (std::max (maximumBlockSize, 0)) + simd::width, 0.0f);
+    setCurrentAndTarget (target);
+}
+
+void ParameterSmoother::setCurrentAndTarget (float value) noexcept
+{
+    current = value;
+    target = value;
+    stepsRemaining = 0;
+}
+
+void ParameterSmoother::setTarget (float newTarget) noexcept
+{
+    if (newTarget == target)
+        return;
+
+    target = newTarget;
+
+    if (rampLengthSamples <= 0 || (type == Type::multiplicative && (current <= 0.0f || newTarget <= 0.0f)))
+    {
+        setCurrentAndTarget (newTarget);
+        return;
+    }
+
+    stepsRemaining = rampLengthSamples;
+
+    if (type == Type::linear)
+        step = (target - current) / static_cast<float> (rampLengthSamples);
+    else
+        ratio = static_cast<float> (std::exp (std::log (static_cast<double> (target) / static_cast<double> (current))
+                                              / static_cast<double> (rampLengthSamples)));
+}
+
+const float* ParameterSmoother::next (int numSamples) noexcept
+{
+    if (stepsRemaining <= 0 || numSamples <= 0)
+        return nullptr;
+
+    const int rampSamples = std::min (numSamples, stepsRemaining);
+    auto* out = ramp.data();
+
+    // The buffer has simd::width spare floats, so the last vector may run past
+    // rampSamples; the tail fill below overwrites anything written there.
+    if (type == Type::linear)
+    {
+        // current + step * n, computed from the index rather than accumulated
+        // so rounding does not build up along the ramp.
+        const auto start = simd::broadcast (current);
+        const auto increment = simd::broadcast (step);
+        const auto four = simd::broadcast (4.0f);
+        auto index = simd::make (1.0f, 2.0f, 3.0f, 4.0f);
+
+        for (int i = 0; i < rampSamples; i += simd::width)
+        {
+            simd::store (out + i, simd::add (start, simd::mul (increment, index)));
+            index = simd::add (index, four);
+        }
+    }
+    else
+    {
+        const auto ratio2 = ratio * ratio;
+        const auto ratio4 = simd::broadcast (ratio2 * ratio2);
+        auto values = simd::mul (simd::broadcast (current), simd::make (ratio, ratio2, ratio2 * ratio, ratio2 * ratio2));
+
+        for (int i = 0; i < rampSamples; i += simd::width)
+        {
+            simd::store (out + i, values);
+            values = simd::mul (values, ratio4);
+        }
+    }
+
+    stepsRemaining -= rampSamples;
+
+    if (stepsRemaining == 0)
+    {
+        current = target;
+        out[rampSamples - 1] = target;
+        std::fill (out + rampSamples, out + numSamples, target);
+    }
+    else
+    {
+        current = out[rampSamples - 1];
+    }
+
+    return out;
+}
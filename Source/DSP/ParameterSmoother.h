@@ -0,0 +1,47 @@
+#pragma once
+
+#include <vector>
+
+// Per-sample parameter smoothing that works a block at a time. next() writes
+// the block's ramp into a buffer allocated in prepare() with a SIMD kernel, and
+// returns nullptr without touching any samples once the target is reached, so
+// a static parameter costs one comparison per block.
+class ParameterSmoother
+{
+public:
+    enum class Type
+    {
+        linear,
+        // Constant ratio per sample; values must stay above zero (gains).
+        multiplicative
+    };
+
+    void prepare (double sampleRate, double rampSeconds, int maximumBlockSize, Type newType);
+
+    // Jumps straight to value with no ramp.
+    void setCurrentAndTarget (float value) noexcept;
+
+    // Starts a new ramp from the current value; a no-op if newTarget is already
+    // the target, so it is cheap to call every block.
+    void setTarget (float newTarget) noexcept;
+
+    float getCurrentValue() const noexcept { return current; }
+    float getTargetValue() const noexcept { return target; }
+    bool isSmoothing() const noexcept { return stepsRemaining > 0; }
+
+    // Returns numSamples smoothed values (numSamples must not exceed the
+    // maximum block size), or nullptr when the value is constant for the whole
+    // block, in which case getCurrentValue() is that value. An empty block
+    // returns nullptr and leaves the ramp where it was.
+    const float* next (int numSamples) noexcept;
+
+private:
+    Type type = Type::linear;
+    int rampLengthSamples = 0;
+    int stepsRemaining = 0;
+    float current = 0.0f;
+    float target = 0.0f;
+    float step = 0.0f;
+    float ratio = 1.0f;
+    std::vector<float> ramp;
+};
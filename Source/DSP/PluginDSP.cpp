@@ -0,0 +1,493 @@
+#include "PluginDSP.h"
+#include "SIMD.h"
+
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+
+namespace
+{
+// Gain and mix each come either from a per-sample ramp or a block constant.
+// The four combinations are separate instantiations so the sample loop never
+// branches on whether a parameter is moving.
+//
+// Buffers are planar, so each vector holds four consecutive samples of one
+// channel. numChannels is a compile-time count for the common layouts (0
+// means "use runtimeChannels"): the channel loop then unrolls, and every
+// channel of a frame group shares the one gain and mix load.
+template <int numChannels, bool gainIsRamp, bool mixIsRamp>
+void processFrames (float* const* channels, int runtimeChannels, int numSamples,
+                    const float* gainRamp, float gain, const float* mixRamp, float mix) noexcept
+{
+    const auto channelCount = numChannels > 0 ? numChannels : runtimeChannels;
+    const auto numVectorSamples = numSamples - numSamples % simd::width;
+
+    auto shape = [] (float* samples, simd::float4 g, simd::float4 m) noexcept
+    {
+        const auto input = simd::load (samples);
+        const auto shaped = simd::tanh (simd::mul (g, input));
+        simd::store (samples, simd::add (input, simd::mul (m, simd::sub (shaped, input))));
+    };
+
+    for (int i = 0; i < numVectorSamples; i += simd::width)
+    {
+        const auto g = gainIsRamp ? simd::load (gainRamp + i) : simd::broadcast (gain);
+        const auto m = mixIsRamp ? simd::load (mixRamp + i) : simd::broadcast (mix);
+
+        for (int channel = 0; channel < channelCount; ++channel)
+            shape (channels[channel] + i, g, m);
+    }
+
+    // The last few samples go through a padded copy, since host buffers may
+    // end right after them.
+    const auto numTailSamples = numSamples - numVectorSamples;
+    if (numTailSamples == 0)
+        return;
+
+    float gains[simd::width] {}, mixes[simd::width] {}, samples[simd::width] {};
+
+    for (int i = 0; i < numTailSamples; ++i)
+    {
+        gains[i] = gainIsRamp ? gainRamp[numVectorSamples + i] : gain;
+        mixes[i] = mixIsRamp ? mixRamp[numVectorSamples + i] : mix;
+    }
+
+    const auto g = simd::load (gains);
+    const auto m = simd::load (mixes);
+
+    for (int channel = 0; channel < channelCount; ++channel)
+    {
+        auto* tail = channels[channel] + numVectorSamples;
+        std::copy (tail, tail + numTailSamples, samples);
+        shape (samples, g, m);
+        std::copy (samples, samples + numTailSamples, tail);
+    }
+}
+
+// Double-precision counterpart of processFrames. It stays scalar so the whole
+// path runs in double, and shapes with the same rational tanh as the float
+// kernel so both precisions render the same curve.
+template <typename SampleType, bool gainIsRamp, bool mixIsRamp>
+void processSamples (SampleType* const* channels, int numChannels, int numSamples,
+                     const float* gainRamp, float gain, const float* mixRamp, float mix) noexcept
+{
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        auto* samples = channels[channel];
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const auto g = static_cast<SampleType> (gainIsRamp ? gainRamp[i] : gain);
+            const auto m = static_cast<SampleType> (mixIsRamp ? mixRamp[i] : mix);
+            const auto input = samples[i];
+            samples[i] = input + m * (simd::tanhScalar (g * input) - input);
+        }
+    }
+}
+
+// Calls fn with the channel count as a compile-time constant for the layouts
+// worth specialising (mono, stereo, 5.1, 7.1 and 7.1.4), or with 0 otherwise.
+template <typename Fn>
+void withChannelCount (int numChannels, Fn&& fn) noexcept
+{
+    switch (numChannels)
+    {
+        case 1:  fn (std::integral_constant<int, 1>()); break;
+        case 2:  fn (std::integral_constant<int, 2>()); break;
+        case 6:  fn (std::integral_constant<int, 6>()); break;
+        case 8:  fn (std::integral_constant<int, 8>()); break;
+        case 12: fn (std::integral_constant<int, 12>()); break;
+        default: fn (std::integral_constant<int, 0>()); break;
+    }
+}
+
+// With oversampling or ADAA the waveshaper runs as its own pass, possibly at a
+// higher rate. Each base-rate gain value covers 2^factorLog2 consecutive
+// samples of that pass, so from 4x up a group of four shares a single gain.
+template <bool gainIsRamp>
+void shapeDirect (float* samples, int numSamples, int factorLog2, const float* gainRamp, float gain) noexcept
+{
+    const auto numVectorSamples = numSamples - numSamples % simd::width;
+
+    for (int i = 0; i < numVectorSamples; i += simd::width)
+    {
+        simd::float4 g;
+
+        if constexpr (! gainIsRamp)
+            g = simd::broadcast (gain);
+        else if (factorLog2 >= 2)
+            g = simd::broadcast (gainRamp[i >> factorLog2]);
+        else if (factorLog2 == 1)
+            g = simd::make (gainRamp[i >> 1], gainRamp[i >> 1], gainRamp[(i >> 1) + 1], gainRamp[(i >> 1) + 1]);
+        else
+            g = simd::load (gainRamp + i);
+
+        simd::store (samples + i, simd::tanh (simd::mul (g, simd::load (samples + i))));
+    }
+
+    // Below 4x a block can end partway through a group; finish it through a
+    // padded copy, as processFrames() does.
+    const auto numTailSamples = numSamples - numVectorSamples;
+    if (numTailSamples == 0)
+        return;
+
+    float gains[simd::width] {}, tail[simd::width] {};
+
+    for (int i = 0; i < numTailSamples; ++i)
+    {
+        gains[i] = gainIsRamp ? gainRamp[(numVectorSamples + i) >> factorLog2] : gain;
+        tail[i] = samples[numVectorSamples + i];
+    }
+
+    simd::store (tail, simd::tanh (simd::mul (simd::load (gains), simd::load (tail))));
+    std::copy (tail, tail + numTailSamples, samples + numVectorSamples);
+}
+
+// The dry path is kept in double, so Mix at 0 passes the input through
+// exactly at either precision.
+template <typename SampleType, bool mixIsRamp>
+void mixWithDry (SampleType* output, const float* wet, const double* dry, int numSamples, const float* mixRamp, float mix) noexcept
+{
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const auto m = static_cast<double> (mixIsRamp ? mixRamp[i] : mix);
+        output[i] = static_cast<SampleType> (dry[i] + m * (static_cast<double> (wet[i]) - dry[i]));
+    }
+}
+
+// Blends towards the delayed dry signal by the bypass fade amount.
+template <typename SampleType>
+void crossfadeToDry (SampleType* samples, const double* dry, int numSamples, const float* fade) noexcept
+{
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const auto processed = static_cast<double> (samples[i]);
+        samples[i] = static_cast<SampleType> (processed + static_cast<double> (fade[i]) * (dry[i] - processed));
+    }
+}
+
+// Index of the last sample above threshold in any channel, or -1. Scans
+// backwards, so blocks that end loud return almost immediately.
+template <typename SampleType>
+int findLastLoudSample (const SampleType* const* channels, int numChannels, int numSamples, SampleType threshold) noexcept
+{
+    int last = -1;
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        const auto* samples = channels[channel];
+        for (int i = numSamples - 1; i > last; --i)
+        {
+            if (std::abs (samples[i]) > threshold)
+            {
+                last = i;
+                break;
+            }
+        }
+    }
+
+    return last;
+}
+} // namespace
+
+__PLUGIN_NAME__DSP::__PLUGIN_NAME__DSP()
+{
+    driveGain.setCurrentAndTarget (1.0f);
+    mix.setCurrentAndTarget (1.0f);
+    bypassFade.setCurrentAndTarget (0.0f);
+}
+
+void __PLUGIN_NAME__DSP::prepare (double newSampleRate, int newMaximumBlockSize, int newNumChannels)
+{
+    sampleRate = newSampleRate;
+    maximumBlockSize = newMaximumBlockSize;
+    numChannels = newNumChannels;
+    silenceHoldSamples = static_cast<int> (std::ceil (sampleRate * silenceHoldSeconds));
+
+    driveGain.prepare (sampleRate, smoothingSeconds, maximumBlockSize, ParameterSmoother::Type::multiplicative);
+    mix.prepare (sampleRate, smoothingSeconds, maximumBlockSize, ParameterSmoother::Type::linear);
+    bypassFade.prepare (sampleRate, smoothingSeconds, maximumBlockSize, ParameterSmoother::Type::linear);
+
+    oversampling.prepare (numChannels, maximumBlockSize);
+    antiderivativeTanh.prepare (numChannels);
+
+    // Size the dry delay for the longest latency any mode can report, so that
+    // switching modes later never needs to reallocate.
+    int maxLatency = 0;
+
+    for (auto type : { Oversampling::FilterType::iir, Oversampling::FilterType::linearPhase })
+    {
+        for (int factor = 0; factor <= Oversampling::maxFactorLog2; ++factor)
+            maxLatency = std::max (maxLatency, oversampling.getLatencySamples (factor, type));
+    }
+
+    dryDelaySize = maxLatency + 1;
+    dryDelay.assign (static_cast<size_t> (numChannels * dryDelaySize), 0.0);
+    dryBlock.assign (static_cast<size_t> (numChannels * maximumBlockSize), 0.0);
+
+    wetBlock.assign (static_cast<size_t> (numChannels * maximumBlockSize), 0.0f);
+    wetChannels.resize (static_cast<size_t> (numChannels));
+
+    for (int channel = 0; channel < numChannels; ++channel)
+        wetChannels[static_cast<size_t> (channel)] = wetBlock.data() + channel * maximumBlockSize;
+
+    reset();
+}
+
+void __PLUGIN_NAME__DSP::reset() noexcept
+{
+    driveGain.setCurrentAndTarget (driveGain.getTargetValue());
+    mix.setCurrentAndTarget (mix.getTargetValue());
+    bypassFade.setCurrentAndTarget (bypassFade.getTargetValue());
+
+    clearHistory();
+    silentSamples = 0;
+    sleeping = false;
+    bypassed = false;
+}
+
+void __PLUGIN_NAME__DSP::clearHistory() noexcept
+{
+    oversampling.reset();
+    antiderivativeTanh.reset();
+    std::fill (dryDelay.begin(), dryDelay.end(), 0.0);
+    dryDelayPosition = 0;
+}
+
+int __PLUGIN_NAME__DSP::getTailSamples() const noexcept
+{
+    // The shaper itself is memoryless apart from ADAA's one-sample history.
+    return std::max (oversampling.getTailSamples(), oversampling.getLatencySamples()) + (useAntiderivative ? 1 : 0);
+}
+
+void __PLUGIN_NAME__DSP::setDrive (float newDriveDecibels) noexcept
+{
+    driveGain.setTarget (std::pow (10.0f, newDriveDecibels / 20.0f));
+}
+
+void __PLUGIN_NAME__DSP::setMix (float newMixProportion) noexcept
+{
+    mix.setTarget (std::clamp (newMixProportion, 0.0f, 1.0f));
+}
+
+void __PLUGIN_NAME__DSP::setOversampling (int factorLog2, Oversampling::FilterType filterType) noexcept
+{
+    if (factorLog2 == oversampling.getFactorLog2() && filterType == oversampling.getFilterType())
+        return;
+
+    oversampling.setMode (factorLog2, filterType);
+    clearHistory();
+}
+
+void __PLUGIN_NAME__DSP::setAntialiasing (bool shouldUseAntiderivative) noexcept
+{
+    if (shouldUseAntiderivative == useAntiderivative)
+        return;
+
+    useAntiderivative = shouldUseAntiderivative;
+    antiderivativeTanh.reset();
+}
+
+void __PLUGIN_NAME__DSP::setBypassed (bool shouldBeBypassed) noexcept
+{
+    bypassFade.setTarget (shouldBeBypassed ? 1.0f : 0.0f);
+}
+
+template <typename SampleType>
+void __PLUGIN_NAME__DSP::process (SampleType* const* channels, int numChannelsToProcess, int numSamples) noexcept
+{
+    // VST3 hosts send empty blocks to flush parameter changes.
+    if (numSamples <= 0)
+        return;
+
+    if (bypassFade.getTargetValue() >= 1.0f && ! bypassFade.isSmoothing())
+    {
+        // The shaper state is stale by the time the bypass is released, so it
+        // restarts from silence, underneath the fade back in.
+        if (! bypassed)
+        {
+            oversampling.reset();
+            antiderivativeTanh.reset();
+            bypassed = true;
+        }
+
+        driveGain.setCurrentAndTarget (driveGain.getTargetValue());
+        mix.setCurrentAndTarget (mix.getTargetValue());
+        silentSamples = 0;
+        sleeping = false;
+
+        delayDry (channels, numChannelsToProcess, numSamples);
+
+        for (int channel = 0; channel < numChannelsToProcess; ++channel)
+        {
+            const auto* dry = dryBlock.data() + channel * maximumBlockSize;
+            std::transform (dry, dry + numSamples, channels[channel], [] (double sample) { return static_cast<SampleType> (sample); });
+        }
+
+        return;
+    }
+
+    bypassed = false;
+
+    // While tanh is near-linear the output is dry + mix * (g * x - dry), which
+    // for any Mix is at most max (1, g) times the input.
+    const auto maxGain = std::max ({ 1.0f, driveGain.getCurrentValue(), driveGain.getTargetValue() });
+    const auto lastLoudSample = findLastLoudSample (channels, numChannelsToProcess, numSamples,
+                                                    static_cast<SampleType> (silenceThreshold / maxGain));
+
+    if (lastLoudSample >= 0)
+    {
+        silentSamples = numSamples - 1 - lastLoudSample;
+        sleeping = false;
+    }
+    else
+    {
+        const auto wasSilentForTail = silentSamples >= getTailSamples() + silenceHoldSamples;
+        silentSamples += numSamples;
+
+        if (wasSilentForTail)
+        {
+            // Whatever the filters still hold is below the threshold; dropping
+            // it means the next loud block starts from a clean state.
+            if (! sleeping)
+            {
+                clearHistory();
+                sleeping = true;
+            }
+
+            driveGain.setCurrentAndTarget (driveGain.getTargetValue());
+            mix.setCurrentAndTarget (mix.getTargetValue());
+            bypassFade.setCurrentAndTarget (bypassFade.getTargetValue());
+
+            for (int channel = 0; channel < numChannelsToProcess; ++channel)
+                std::fill (channels[channel], channels[channel] + numSamples, SampleType (0));
+
+            return;
+        }
+    }
+
+    const auto gain = driveGain.getCurrentValue();
+    const auto wet = mix.getCurrentValue();
+    const auto* gainRamp = driveGain.next (numSamples);
+    const auto* mixRamp = mix.next (numSamples);
+    const auto* bypassRamp = bypassFade.next (numSamples);
+    const auto usesWetAndDry = oversampling.getFactor() > 1 || useAntiderivative;
+
+    if (usesWetAndDry || bypassRamp != nullptr)
+        delayDry (channels, numChannelsToProcess, numSamples);
+
+    if (usesWetAndDry)
+    {
+        processWetAndDry (channels, numChannelsToProcess, numSamples, gainRamp, gain, mixRamp, wet);
+    }
+    else if constexpr (std::is_same_v<SampleType, float>)
+    {
+        withChannelCount (numChannelsToProcess, [&] (auto channelCount) noexcept
+        {
+            constexpr int count = decltype (channelCount)::value;
+
+            if (gainRamp != nullptr && mixRamp != nullptr)
+                processFrames<count, true, true> (channels, numChannelsToProcess, numSamples, gainRamp, gain, mixRamp, wet);
+            else if (gainRamp != nullptr)
+                processFrames<count, true, false> (channels, numChannelsToProcess, numSamples, gainRamp, gain, mixRamp, wet);
+            else if (mixRamp != nullptr)
+                processFrames<count, false, true> (channels, numChannelsToProcess, numSamples, gainRamp, gain, mixRamp, wet);
+            else
+                processFrames<count, false, false> (channels, numChannelsToProcess, numSamples, gainRamp, gain, mixRamp, wet);
+        });
+    }
+    else
+    {
+        if (gainRamp != nullptr && mixRamp != nullptr)
+            processSamples<SampleType, true, true> (channels, numChannelsToProcess, numSamples, gainRamp, gain, mixRamp, wet);
+        else if (gainRamp != nullptr)
+            processSamples<SampleType, true, false> (channels, numChannelsToProcess, numSamples, gainRamp, gain, mixRamp, wet);
+        else if (mixRamp != nullptr)
+            processSamples<SampleType, false, true> (channels, numChannelsToProcess, numSamples, gainRamp, gain, mixRamp, wet);
+        else
+            processSamples<SampleType, false, false> (channels, numChannelsToProcess, numSamples, gainRamp, gain, mixRamp, wet);
+    }
+
+    if (bypassRamp != nullptr)
+    {
+        for (int channel = 0; channel < numChannelsToProcess; ++channel)
+            crossfadeToDry (channels[channel], dryBlock.data() + channel * maximumBlockSize, numSamples, bypassRamp);
+    }
+}
+
+template <typename SampleType>
+void __PLUGIN_NAME__DSP::delayDry (const SampleType* const* channels, int numChannelsToProcess, int numSamples) noexcept
+{
+    const auto latency = oversampling.getLatencySamples();
+
+    for (int channel = 0; channel < numChannelsToProcess; ++channel)
+    {
+        const auto* input = channels[channel];
+        auto* ring = dryDelay.data() + channel * dryDelaySize;
+        auto* dry = dryBlock.data() + channel * maximumBlockSize;
+        auto writePosition = dryDelayPosition;
+        auto readPosition = (dryDelayPosition + dryDelaySize - latency) % dryDelaySize;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            ring[writePosition] = static_cast<double> (input[i]);
+            dry[i] = ring[readPosition];
+            writePosition = writePosition + 1 < dryDelaySize ? writePosition + 1 : 0;
+            readPosition = readPosition + 1 < dryDelaySize ? readPosition + 1 : 0;
+        }
+    }
+
+    dryDelayPosition = (dryDelayPosition + numSamples) % dryDelaySize;
+}
+
+template <typename SampleType>
+void __PLUGIN_NAME__DSP::processWetAndDry (SampleType* const* channels, int numChannelsToProcess, int numSamples,
+                                           const float* gainRamp, float gain, const float* mixRamp, float wet) noexcept
+{
+    // The oversampling filters and the ADAA tables are single precision, so a
+    // double block is shaped through a float copy and only the dry path and
+    // the final mix run in double.
+    float* const* wetSignal = nullptr;
+
+    if constexpr (std::is_same_v<SampleType, float>)
+    {
+        wetSignal = channels;
+    }
+    else
+    {
+        for (int channel = 0; channel < numChannelsToProcess; ++channel)
+            std::transform (channels[channel], channels[channel] + numSamples, wetChannels[static_cast<size_t> (channel)],
+                            [] (SampleType sample) { return static_cast<float> (sample); });
+
+        wetSignal = wetChannels.data();
+    }
+
+    const auto factorLog2 = oversampling.getFactorLog2();
+    auto* const* shaped = factorLog2 > 0 ? oversampling.processUp (wetSignal, numChannelsToProcess, numSamples) : wetSignal;
+
+    for (int channel = 0; channel < numChannelsToProcess; ++channel)
+    {
+        if (useAntiderivative)
+            antiderivativeTanh.process (channel, shaped[channel], numSamples << factorLog2, gainRamp, gain, factorLog2);
+        else if (gainRamp != nullptr)
+            shapeDirect<true> (shaped[channel], numSamples << factorLog2, factorLog2, gainRamp, gain);
+        else
+            shapeDirect<false> (shaped[channel], numSamples << factorLog2, factorLog2, gainRamp, gain);
+    }
+
+    if (factorLog2 > 0)
+        oversampling.processDown (wetSignal, numChannelsToProcess, numSamples);
+
+    for (int channel = 0; channel < numChannelsToProcess; ++channel)
+    {
+        const auto* dry = dryBlock.data() + channel * maximumBlockSize;
+
+        if (mixRamp != nullptr)
+            mixWithDry<SampleType, true> (channels[channel], wetSignal[channel], dry, numSamples, mixRamp, wet);
+        else
+            mixWithDry<SampleType, false> (channels[channel], wetSignal[channel], dry, numSamples, mixRamp, wet);
+    }
+}
+
+template void __PLUGIN_NAME__DSP::process<float> (float* const*, int, int) noexcept;
+template void __PLUGIN_NAME__DSP::process<double> (double* const*, int, int) noexcept;
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "AntiderivativeTanh.h"
+#include "Oversampling.h"
+#include "ParameterSmoother.h"
+
+#include <cstdint>
+#include <vector>
+
+// The plugin's signal processing, kept free of JUCE so it can be built as a
+// plain static library and driven directly by the native benchmark
+// (tools/dsp_bench) as well as by __PLUGIN_NAME__AudioProcessor.
+
+class __PLUGIN_NAME__DSP
+{
+public:
+    __PLUGIN_NAME__DSP();
+
+    void prepare (double newSampleRate, int newMaximumBlockSize, int newNumChannels);
+    void reset() noexcept;
+
+    // Parameter setters are called from the audio thread before process().
+    // Changes are smoothed over smoothingSeconds.
+    void setDrive (float newDriveDecibels) noexcept;
+    void setMix (float newMixProportion) noexcept;
+
+    // Selects 1x, 2x, 4x or 8x oversampling (factorLog2 0 to 3) around the
+    // waveshaper. Switching never allocates but clears the filter state, and
+    // changes getLatencySamples().
+    void setOversampling (int factorLog2, Oversampling::FilterType filterType) noexcept;
+
+    // Uses the antiderivative anti-aliased waveshaper instead of plain tanh.
+    // An alternative to oversampling for low CPU use (the two also combine);
+    // it adds half a sample of delay, which is not reported as latency.
+    void setAntialiasing (bool shouldUseAntiderivative) noexcept;
+
+    // Crossfades over smoothingSeconds to the input, delayed by
+    // getLatencySamples() so it lines up with the processed signal. Once the
+    // fade is complete process() only runs that delay line.
+    void setBypassed (bool shouldBeBypassed) noexcept;
+
+    // Processes numSamples samples of each channel in place. numSamples must not
+    // exceed the maximum block size given to prepare() (callers split larger
+    // blocks), and numChannels must not exceed its channel count. An empty block
+    // is a no-op. Never allocates or locks.
+    //
+    // Once the output would have stayed below silenceThreshold for longer than
+    // getTailSamples() plus silenceHoldSeconds, blocks are cleared instead of
+    // processed. The input is compared against the threshold divided by the
+    // largest gain the current Drive can apply, so quiet input that Drive
+    // would bring up is never dropped. The hold keeps material hovering around
+    // the threshold from switching in and out of sleep. The first block with
+    // any input sample above the scaled threshold is processed in full.
+    //
+    // Instantiated for float and double, with the same tanh approximation in
+    // both. At 1x without ADAA a double block is processed entirely in
+    // double. With oversampling or ADAA the wet path (the halfband filters,
+    // the shaper and the ADAA tables) runs in float, and only the dry delay,
+    // the Mix blend and the bypass crossfade stay in double.
+    template <typename SampleType>
+    void process (SampleType* const* channels, int numChannels, int numSamples) noexcept;
+
+    double getSampleRate() const noexcept { return sampleRate; }
+    int getMaximumBlockSize() const noexcept { return maximumBlockSize; }
+    int getNumChannels() const noexcept { return numChannels; }
+    int getLatencySamples() const noexcept { return oversampling.getLatencySamples(); }
+
+    // The latency setOversampling (factorLog2, filterType) would lead to. Safe
+    // to call from any thread.
+    int getLatencySamples (int factorLog2, Oversampling::FilterType filterType) const noexcept
+    {
+        return oversampling.getLatencySamples (factorLog2, filterType);
+    }
+
+    // Samples after the input falls silent before the output does too.
+    int getTailSamples() const noexcept;
+
+    // True while process() is skipping silent blocks.
+    bool isSleeping() const noexcept { return sleeping; }
+
+    // True once a bypass crossfade has finished.
+    bool isBypassed() const noexcept { return bypassed; }
+
+    static constexpr double smoothingSeconds = 0.02;
+    static constexpr float silenceThreshold = 1.0e-5f;
+    static constexpr double silenceHoldSeconds = 0.05;
+
+private:
+    void clearHistory() noexcept;
+
+    template <typename SampleType>
+    void delayDry (const SampleType* const* channels, int numChannelsToProcess, int numSamples) noexcept;
+
+    // Expects delayDry() to have filled dryBlock for this block.
+    template <typename SampleType>
+    void processWetAndDry (SampleType* const* channels, int numChannelsToProcess, int numSamples,
+                           const float* gainRamp, float gain, const float* mixRamp, float wet) noexcept;
+
+    double sampleRate = 44100.0;
+    int maximumBlockSize = 0;
+    int numChannels = 0;
+
+    ParameterSmoother driveGain;
+    ParameterSmoother mix;
+
+    // 0 while processing, 1 while bypassed.
+    ParameterSmoother bypassFade;
+    bool bypassed = false;
+
+    Oversampling oversampling;
+    AntiderivativeTanh antiderivativeTanh;
+    bool useAntiderivative = false;
+
+    // The dry signal is delayed by the oversampling latency so Mix and the
+    // bypass crossfade blend it in phase with the wet path.
+    std::vector<double> dryDelay;
+    std::vector<double> dryBlock;
+    int dryDelaySize = 0;
+    int dryDelayPosition = 0;
+
+    // Float working copy of the wet signal when processing double blocks.
+    std::vector<float> wetBlock;
+    std::vector<float*> wetChannels;
+
+    // Input samples since the last one above the scaled silenceThreshold.
+    std::int64_t silentSamples = 0;
+    int silenceHoldSamples = 0;
+    bool sleeping = false;
+};
@@ -0,0 +1,168 @@
+#pragma once
+
+// Minimal four-lane float vector used by the DSP kernels: SSE2 on x86, NEON on
+// ARM, plain arrays elsewhere. Only what the kernels need is provided.
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+ #include <emmintrin.h>
+ #define PLUGIN_DSP_SIMD_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+ #include <arm_neon.h>
+ #define PLUGIN_DSP_SIMD_NEON 1
+#endif
+
+namespace simd
+{
+#if PLUGIN_DSP_SIMD_SSE2
+using float4 = __m128;
+
+inline float4 load (const float* source) noexcept                 { return _mm_loadu_ps (source); }
+inline void store (float* dest, float4 value) noexcept            { _mm_storeu_ps (dest, value); }
+inline float4 broadcast (float value) noexcept                    { return _mm_set1_ps (value); }
+inline float4 make (float a, float b, float c, float d) noexcept  { return _mm_setr_ps (a, b, c, d); }
+inline float4 add (float4 a, float4 b) noexcept                   { return _mm_add_ps (a, b); }
+inline float4 sub (float4 a, float4 b) noexcept                   { return _mm_sub_ps (a, b); }
+inline float4 mul (float4 a, float4 b) noexcept                   { return _mm_mul_ps (a, b); }
+inline float4 min (float4 a, float4 b) noexcept                   { return _mm_min_ps (a, b); }
+inline float4 max (float4 a, float4 b) noexcept                   { return _mm_max_ps (a, b); }
+inline float4 div (float4 a, float4 b) noexcept                   { return _mm_div_ps (a, b); }
+inline float4 abs (float4 a) noexcept                             { return _mm_andnot_ps (_mm_set1_ps (-0.0f), a); }
+
+using mask4 = __m128;
+
+inline mask4 lessThan (float4 a, float4 b) noexcept               { return _mm_cmplt_ps (a, b); }
+inline float4 select (mask4 m, float4 a, float4 b) noexcept       { return _mm_or_ps (_mm_and_ps (m, a), _mm_andnot_ps (m, b)); }
+#elif PLUGIN_DSP_SIMD_NEON
+using float4 = float32x4_t;
+
+inline float4 load (const float* source) noexcept                 { return vld1q_f32 (source); }
+inline void store (float* dest, float4 value) noexcept            { vst1q_f32 (dest, value); }
+inline float4 broadcast (float value) noexcept                    { return vdupq_n_f32 (value); }
+inline float4 make (float a, float b, float c, float d) noexcept  { const float values[4] { a, b, c, d }; return vld1q_f32 (values); }
+inline float4 add (float4 a, float4 b) noexcept                   { return vaddq_f32 (a, b); }
+inline float4 sub (float4 a, float4 b) noexcept                   { return vsubq_f32 (a, b); }
+inline float4 mul (float4 a, float4 b) noexcept                   { return vmulq_f32 (a, b); }
+inline float4 min (float4 a, float4 b) noexcept                   { return vminq_f32 (a, b); }
+inline float4 max (float4 a, float4 b) noexcept                   { return vmaxq_f32 (a, b); }
+inline float4 abs (float4 a) noexcept                             { return vabsq_f32 (a); }
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+inline float4 div (float4 a, float4 b) noexcept                   { return vdivq_f32 (a, b); }
+#else
+inline float4 div (float4 a, float4 b) noexcept
+{
+    // ARMv7 NEON has no divide: refine the reciprocal estimate twice.
+    auto reciprocal = vrecpeq_f32 (b);
+    reciprocal = vmulq_f32 (vrecpsq_f32 (b, reciprocal), reciprocal);
+    reciprocal = vmulq_f32 (vrecpsq_f32 (b, reciprocal), reciprocal);
+    return vmulq_f32 (a, reciprocal);
+}
+#endif
+
+using mask4 = uint32x4_t;
+
+inline mask4 lessThan (float4 a, float4 b) noexcept               { return vcltq_f32 (a, b); }
+inline float4 select (mask4 m, float4 a, float4 b) noexcept       { return vbslq_f32 (m, a, b); }
+#else
+struct float4
+{
+    float lanes[4];
+};
+
+inline float4 load (const float* source) noexcept                 { return { { source[0], source[1], source[2], source[3] } }; }
+inline void store (float* dest, float4 value) noexcept            { for (int i = 0; i < 4; ++i) dest[i] = value.lanes[i]; }
+inline float4 broadcast (float value) noexcept                    { return { { value, value, value, value } }; }
+inline float4 make (float a, float b, float c, float d) noexcept  { return { { a, b, c, d } }; }
+
+template <typename Op>
+inline float4 apply (float4 a, float4 b, Op op) noexcept
+{
+    float4 result;
+    for (int i = 0; i < 4; ++i)
+        result.lanes[i] = op (a.lanes[i], b.lanes[i]);
+    return result;
+}
+
+inline float4 add (float4 a, float4 b) noexcept  { return apply (a, b, [] (float x, float y) { return x + y; }); }
+inline float4 sub (float4 a, float4 b) noexcept  { return apply (a, b, [] (float x, float y) { return x - y; }); }
+inline float4 mul (float4 a, float4 b) noexcept  { return apply (a, b, [] (float x, float y) { return x * y; }); }
+inline float4 min (float4 a, float4 b) noexcept  { return apply (a, b, [] (float x, float y) { return y < x ? y : x; }); }
+inline float4 max (float4 a, float4 b) noexcept  { return apply (a, b, [] (float x, float y) { return x < y ? y : x; }); }
+inline float4 div (float4 a, float4 b) noexcept  { return apply (a, b, [] (float x, float y) { return x / y; }); }
+inline float4 abs (float4 a) noexcept            { return apply (a, a, [] (float x, float) { return x < 0.0f ? -x : x; }); }
+
+struct mask4
+{
+    bool lanes[4];
+};
+
+inline mask4 lessThan (float4 a, float4 b) noexcept
+{
+    return { { a.lanes[0] < b.lanes[0], a.lanes[1] < b.lanes[1], a.lanes[2] < b.lanes[2], a.lanes[3] < b.lanes[3] } };
+}
+
+inline float4 select (mask4 m, float4 a, float4 b) noexcept
+{
+    float4 result;
+    for (int i = 0; i < 4; ++i)
+        result.lanes[i] = m.lanes[i] ? a.lanes[i] : b.lanes[i];
+    return result;
+}
+#endif
+
+constexpr int width = 4;
+
+// Rational (13/6) approximation of tanh, accurate to a few float ulps. Beyond
+// the clamp tanh rounds to +-1 in float anyway. tanhScalar() evaluates the
+// same formula on one float or double, so every kernel shapes alike.
+namespace detail
+{
+constexpr double tanhClamp = 7.90531110763549805;
+constexpr int tanhNumeratorSize = 7;
+constexpr int tanhDenominatorSize = 4;
+
+// Highest power first, in x^2.
+constexpr double tanhNumerator[tanhNumeratorSize] { -2.76076847742355e-16, 2.00018790482477e-13, -8.60467152213735e-11,
+                                                    5.12229709037114e-08, 1.48572235717979e-05, 6.37261928875436e-04,
+                                                    4.89352455891786e-03 };
+constexpr double tanhDenominator[tanhDenominatorSize] { 1.19825839466702e-06, 1.18534705686654e-04, 2.26843463243900e-03,
+                                                        4.89352518554385e-03 };
+} // namespace detail
+
+inline float4 tanh (float4 x) noexcept
+{
+    const auto limit = static_cast<float> (detail::tanhClamp);
+    const auto clamped = min (max (x, broadcast (-limit)), broadcast (limit));
+    const auto x2 = mul (clamped, clamped);
+
+    auto p = broadcast (static_cast<float> (detail::tanhNumerator[0]));
+    for (int i = 1; i < detail::tanhNumeratorSize; ++i)
+        p = add (mul (p, x2), broadcast (static_cast<float> (detail::tanhNumerator[i])));
+    p = mul (p, clamped);
+
+    auto q = broadcast (static_cast<float> (detail::tanhDenominator[0]));
+    for (int i = 1; i < detail::tanhDenominatorSize; ++i)
+        q = add (mul (q, x2), broadcast (static_cast<float> (detail::tanhDenominator[i])));
+
+    return div (p, q);
+}
+
+template <typename SampleType>
+inline SampleType tanhScalar (SampleType x) noexcept
+{
+    const auto limit = static_cast<SampleType> (detail::tanhClamp);
+    const auto clamped = x < -limit ? -limit : (x > limit ? limit : x);
+    const auto x2 = clamped * clamped;
+
+    auto p = static_cast<SampleType> (detail::tanhNumerator[0]);
+    for (int i = 1; i < detail::tanhNumeratorSize; ++i)
+        p = p * x2 + static_cast<SampleType> (detail::tanhNumerator[i]);
+    p *= clamped;
+
+    auto q = static_cast<SampleType> (detail::tanhDenominator[0]);
+    for (int i = 1; i < detail::tanhDenominatorSize; ++i)
+        q = q * x2 + static_cast<SampleType> (detail::tanhDenominator[i]);
+
+    return p / q;
+}
+} // namespace simd
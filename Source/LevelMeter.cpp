@@ -0,0 +1,40 @@
+#include "LevelMeter.h"
+
+void LevelMeterFifo::push (const Frame& frame) noexcept
+{
+    const auto scope = fifo.write (1);
+
+    if (scope.blockSize1 > 0)
+        frames[static_cast<size_t> (scope.startIndex1)] = frame;
+}
+
+void LevelMeterFifo::discardPending() noexcept
+{
+    fifo.finishedRead (fifo.getNumReady());
+}
+
+bool LevelMeterFifo::pull (Frame& combined) noexcept
+{
+    combined = {};
+    double inputSum = 0.0;
+    double outputSum = 0.0;
+
+    const auto scope = fifo.read (fifo.getNumReady());
+
+    scope.forEach ([&] (int index)
+    {
+        const auto& frame = frames[static_cast<size_t> (index)];
+        combined.input.peak = juce::jmax (combined.input.peak, frame.input.peak);
+        combined.output.peak = juce::jmax (combined.output.peak, frame.output.peak);
+        inputSum += static_cast<double> (frame.input.meanSquare) * frame.numSamples;
+        outputSum += static_cast<double> (frame.output.meanSquare) * frame.numSamples;
+        combined.numSamples += frame.numSamples;
+    });
+
+    if (combined.numSamples <= 0)
+        return false;
+
+    combined.input.meanSquare = static_cast<float> (inputSum / combined.numSamples);
+    combined.output.meanSquare = static_cast<float> (outputSum / combined.numSamples);
+    return true;
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <JuceHeader.h>
+
+#include <array>
+
+// Carries input and output levels from the audio thread to the editor.
+//
+// The audio thread pushes one Frame per block into a single-producer,
+// single-consumer FIFO: a few atomic loads and stores, no locks and no
+// allocation. The editor drains it on its timer. While no editor is open the
+// FIFO fills up and further frames are simply dropped, so a new editor
+// discards what is queued before it starts pulling.
+class LevelMeterFifo
+{
+public:
+    struct Levels
+    {
+        float peak = 0.0f;
+        float meanSquare = 0.0f;
+    };
+
+    struct Frame
+    {
+        Levels input;
+        Levels output;
+        int numSamples = 0;
+    };
+
+    // Audio thread only.
+    void push (const Frame& frame) noexcept;
+
+    // Message thread only. Combines every frame pushed since the last call
+    // into one (highest peak, sample-weighted mean square); returns false if
+    // there were none.
+    bool pull (Frame& combined) noexcept;
+
+    // Message thread only. Drops every frame pushed so far.
+    void discardPending() noexcept;
+
+    // Peak and mean square over the first numChannels channels, in a single
+    // pass over each channel.
+    template <typename SampleType>
+    static Levels measure (const juce::AudioBuffer<SampleType>& buffer, int numChannels) noexcept
+    {
+        Levels levels;
+        const auto numSamples = buffer.getNumSamples();
+        numChannels = juce::jmin (numChannels, buffer.getNumChannels());
+
+        if (numChannels <= 0 || numSamples <= 0)
+            return levels;
+
+        SampleType peak = 0;
+        double sumOfSquares = 0.0;
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            const auto* samples = buffer.getReadPointer (channel);
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                const auto sample = samples[i];
+                peak = juce::jmax (peak, std::abs (sample));
+                sumOfSquares += static_cast<double> (sample * sample);
+            }
+        }
+
+        levels.peak = static_cast<float> (peak);
+        levels.meanSquare = static_cast<float> (sumOfSquares / (static_cast<double> (numChannels) * numSamples));
+        return levels;
+    }
+
+    // At 30 frames per second this holds over 300 ms of 32-sample blocks at 192 kHz.
+    static constexpr int capacity = 2048;
+
+private:
+    juce::AbstractFifo fifo { capacity };
+    std::array<Frame, capacity> frames;
+};
@@ -1,9 +1,100 @@
 #include "PluginEditor.h"
 
+namespace
+{
+constexpr float peakFallDecibelsPerSecond = 24.0f;
+constexpr float rmsSmoothingSeconds = 0.3f;
+} // namespace
+
+LevelMeterComponent::LevelMeterComponent (juce::String labelText)
+    : label (std::move (labelText))
+{
+    setOpaque (true);
+}
+
+void LevelMeterComponent::setLevels (float newPeakDecibels, float newRmsDecibels)
+{
+    const auto bar = getBarBounds();
+
+    // Sub-pixel changes are not worth a repaint.
+    const auto changed = decibelsToX (newPeakDecibels, bar) != decibelsToX (peakDecibels, bar)
+                      || decibelsToX (newRmsDecibels, bar) != decibelsToX (rmsDecibels, bar);
+
+    peakDecibels = newPeakDecibels;
+    rmsDecibels = newRmsDecibels;
+
+    if (changed)
+        repaint();
+}
+
+juce::Rectangle<int> LevelMeterComponent::getBarBounds() const noexcept
+{
+    return getLocalBounds().withTrimmedLeft (labelWidth);
+}
+
+int LevelMeterComponent::decibelsToX (float decibels, juce::Rectangle<int> bar) const noexcept
+{
+    const auto proportion = juce::jlimit (0.0f, 1.0f, (decibels - minDecibels) / (maxDecibels - minDecibels));
+    return bar.getX() + juce::roundToInt (proportion * static_cast<float> (bar.getWidth()));
+}
+
+void LevelMeterComponent::paint (juce::Graphics& g)
+{
+    const auto bounds = getBarBounds();
+    g.fillAll (juce::Colours::black);
+
+    g.setColour (juce::Colours::white);
+    g.setFont (14.0f);
+    g.drawText (label, getLocalBounds().withWidth (labelWidth), juce::Justification::centredLeft);
+
+    g.setColour (juce::Colour (0xff202020));
+    g.fillRect (bounds);
+
+    const auto zeroX = decibelsToX (0.0f, bounds);
+    const auto rmsX = decibelsToX (rmsDecibels, bounds);
+    const auto peakX = decibelsToX (peakDecibels, bounds);
+
+    g.setColour (juce::Colours::limegreen);
+    g.fillRect (bounds.withRight (juce::jmin (rmsX, zeroX)));
+
+    if (rmsX > zeroX)
+    {
+        g.setColour (juce::Colours::red);
+        g.fillRect (bounds.withLeft (zeroX).withRight (rmsX));
+    }
+
+    g.setColour (peakDecibels > 0.0f ? juce::Colours::red : juce::Colours::white);
+    g.fillRect (juce::Rectangle<int> (peakX - 1, bounds.getY(), 2, bounds.getHeight()));
+
+    g.setColour (juce::Colours::grey);
+    g.drawVerticalLine (zeroX, static_cast<float> (bounds.getY()), static_cast<float> (bounds.getBottom()));
+}
+
+void __PLUGIN_NAME__AudioProcessorEditor::Ballistics::update (float peakGain, float meanSquare, bool hasNewLevels) noexcept
+{
+    constexpr auto frameSeconds = 1.0f / static_cast<float> (meterFramesPerSecond);
+    constexpr auto minimum = LevelMeterComponent::minDecibels;
+
+    const auto newPeak = hasNewLevels ? juce::Decibels::gainToDecibels (peakGain, minimum) : minimum;
+    const auto newRms = hasNewLevels ? juce::Decibels::gainToDecibels (std::sqrt (meanSquare), minimum) : minimum;
+
+    peakDecibels = juce::jmax (newPeak, peakDecibels - peakFallDecibelsPerSecond * frameSeconds, minimum);
+
+    const auto coefficient = 1.0f - std::exp (-frameSeconds / rmsSmoothingSeconds);
+    rmsDecibels += coefficient * (newRms - rmsDecibels);
+}
+
 __PLUGIN_NAME__AudioProcessorEditor::__PLUGIN_NAME__AudioProcessorEditor (__PLUGIN_NAME__AudioProcessor& p)
     : AudioProcessorEditor (&p), processor (p)
 {
+    addAndMakeVisible (inputMeter);
+    addAndMakeVisible (outputMeter);
+
+    // Whatever queued up while no editor was open is stale.
+    processor.getLevelMeterFifo().discardPending();
+
     setSize (420, 260);
+    startTimerHz (meterFramesPerSecond);
 }
 
 void __PLUGIN_NAME__AudioProcessorEditor::paint (juce::Graphics& g)
@@ -11,7 +102,27 @@ void __PLUGIN_NAME__AudioProcessorEditor::paint (juce::Graphics& g)
     g.fillAll (juce::Colours::black);
     g.setColour (juce::Colours::white);
     g.setFont (20.0f);
-    g.drawFittedText ("__PLUGIN_NAME__", getLocalBounds(), juce::Justification::centred, 1);
+    g.drawFittedText ("__PLUGIN_NAME__", getLocalBounds().removeFromTop (140), juce::Justification::centred, 1);
 }
 
-void __PLUGIN_NAME__AudioProcessorEditor::resized() {}
+void __PLUGIN_NAME__AudioProcessorEditor::resized()
+{
+    auto bounds = getLocalBounds().reduced (20);
+    bounds.removeFromTop (120);
+
+    inputMeter.setBounds (bounds.removeFromTop (20));
+    bounds.removeFromTop (16);
+    outputMeter.setBounds (bounds.removeFromTop (20));
+}
+
+void __PLUGIN_NAME__AudioProcessorEditor::timerCallback()
+{
+    LevelMeterFifo::Frame frame;
+    const auto hasNewLevels = processor.getLevelMeterFifo().pull (frame);
+
+    inputBallistics.update (frame.input.peak, frame.input.meanSquare, hasNewLevels);
+    outputBallistics.update (frame.output.peak, frame.output.meanSquare, hasNewLevels);
+
+    inputMeter.setLevels (inputBallistics.peakDecibels, inputBallistics.rmsDecibels);
+    outputMeter.setLevels (outputBallistics.peakDecibels, outputBallistics.rmsDecibels);
+}
@@ -2,7 +2,35 @@
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
 
-class __PLUGIN_NAME__AudioProcessorEditor : public juce::AudioProcessorEditor
+// Horizontal peak and RMS bar. Opaque and only repainted when what it shows
+// has visibly changed, so meter updates never repaint the rest of the editor.
+class LevelMeterComponent : public juce::Component
+{
+public:
+    explicit LevelMeterComponent (juce::String labelText);
+
+    void setLevels (float newPeakDecibels, float newRmsDecibels);
+    void paint (juce::Graphics&) override;
+
+    static constexpr float minDecibels = -60.0f;
+    static constexpr float maxDecibels = 6.0f;
+
+private:
+    static constexpr int labelWidth = 36;
+
+    // The area right of the label that the levels are drawn in.
+    juce::Rectangle<int> getBarBounds() const noexcept;
+    int decibelsToX (float decibels, juce::Rectangle<int> bar) const noexcept;
+
+    juce::String label;
+    float peakDecibels = minDecibels;
+    float rmsDecibels = minDecibels;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LevelMeterComponent)
+};
+
+class __PLUGIN_NAME__AudioProcessorEditor : public juce::AudioProcessorEditor,
+                                           private juce::Timer
 {
 public:
     explicit __PLUGIN_NAME__AudioProcessorEditor (__PLUGIN_NAME__AudioProcessor&);
@@ -12,6 +40,26 @@ public:
     void resized() override;
 
 private:
+    void timerCallback() override;
+
+    static constexpr int meterFramesPerSecond = 30;
+
     __PLUGIN_NAME__AudioProcessor& processor;
+
+    LevelMeterComponent inputMeter { "In" };
+    LevelMeterComponent outputMeter { "Out" };
+
+    // Displayed levels with peak fall-off and RMS smoothing applied.
+    struct Ballistics
+    {
+        float peakDecibels = LevelMeterComponent::minDecibels;
+        float rmsDecibels = LevelMeterComponent::minDecibels;
+
+        void update (float peakGain, float meanSquare, bool hasNewLevels) noexcept;
+    };
+
+    Ballistics inputBallistics;
+    Ballistics outputBallistics;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (__PLUGIN_NAME__AudioProcessorEditor)
 };
@@ -4,23 +4,199 @@
 __PLUGIN_NAME__AudioProcessor::__PLUGIN_NAME__AudioProcessor()
     : AudioProcessor (BusesProperties()
         .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
-        .withOutput ("Output", juce::AudioChannelSet::stereo(), true))
+        .withOutput ("Output", juce::AudioChannelSet::stereo(), true)),
+      parameters (*this, nullptr, "PARAMETERS", createParameterLayout())
 {
+    driveParameter = parameters.getRawParameterValue (ParamIDs::drive);
+    mixParameter = parameters.getRawParameterValue (ParamIDs::mix);
+    oversamplingParameter = parameters.getRawParameterValue (ParamIDs::oversampling);
+    oversamplingFilterParameter = parameters.getRawParameterValue (ParamIDs::oversamplingFilter);
+    antialiasingParameter = parameters.getRawParameterValue (ParamIDs::antialiasing);
+    bypassValue = parameters.getRawParameterValue (ParamIDs::bypass);
+    bypassParameter = parameters.getParameter (ParamIDs::bypass);
+    jassert (driveParameter != nullptr && mixParameter != nullptr);
+    jassert (oversamplingParameter != nullptr && oversamplingFilterParameter != nullptr && antialiasingParameter != nullptr);
+    jassert (bypassValue != nullptr && bypassParameter != nullptr);
+
+    parameters.addParameterListener (ParamIDs::oversampling, this);
+    parameters.addParameterListener (ParamIDs::oversamplingFilter, this);
+}
+
+__PLUGIN_NAME__AudioProcessor::~__PLUGIN_NAME__AudioProcessor()
+{
+    parameters.removeParameterListener (ParamIDs::oversampling, this);
+    parameters.removeParameterListener (ParamIDs::oversamplingFilter, this);
+}
+
+juce::AudioProcessorValueTreeState::ParameterLayout __PLUGIN_NAME__AudioProcessor::createParameterLayout()
+{
+    juce::AudioProcessorValueTreeState::ParameterLayout layout;
+
+    layout.add (std::make_unique<juce::AudioParameterFloat> (juce::ParameterID { ParamIDs::drive, 1 },
+                                                             "Drive",
+                                                             juce::NormalisableRange<float> (0.0f, 24.0f, 0.01f),
+                                                             0.0f,
+                                                             juce::AudioParameterFloatAttributes().withLabel ("dB")));
+
+    layout.add (std::make_unique<juce::AudioParameterFloat> (juce::ParameterID { ParamIDs::mix, 1 },
+                                                             "Mix",
+                                                             juce::NormalisableRange<float> (0.0f, 100.0f, 0.1f),
+                                                             100.0f,
+                                                             juce::AudioParameterFloatAttributes().withLabel ("%")));
+
+    // Both change the reported latency, so they are not offered for automation.
+    layout.add (std::make_unique<juce::AudioParameterChoice> (juce::ParameterID { ParamIDs::oversampling, 1 },
+                                                              "Oversampling",
+                                                              juce::StringArray { "Off", "2x", "4x", "8x" },
+                                                              1,
+                                                              juce::AudioParameterChoiceAttributes().withAutomatable (false)));
+
+    layout.add (std::make_unique<juce::AudioParameterChoice> (juce::ParameterID { ParamIDs::oversamplingFilter, 1 },
+                                                              "Oversampling Filter",
+                                                              juce::StringArray { "Linear Phase", "Low Latency" },
+                                                              0,
+                                                              juce::AudioParameterChoiceAttributes().withAutomatable (false)));
+
+    layout.add (std::make_unique<juce::AudioParameterBool> (juce::ParameterID { ParamIDs::antialiasing, 1 },
+                                                            "ADAA",
+                                                            false,
+                                                            juce::AudioParameterBoolAttributes().withAutomatable (false)));
+
+    // Returned from getBypassParameter(), so hosts drive it from their own
+    // bypass button.
+    layout.add (std::make_unique<juce::AudioParameterBool> (juce::ParameterID { ParamIDs::bypass, 1 },
+                                                            "Bypass",
+                                                            false));
+
+    return layout;
+}
+
+void __PLUGIN_NAME__AudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
+{
+    // Set the targets first so prepare() starts from them instead of ramping.
+    dsp.setDrive (driveParameter->load (std::memory_order_relaxed));
+    dsp.setMix (mixParameter->load (std::memory_order_relaxed) / 100.0f);
+    dsp.setBypassed (bypassValue->load (std::memory_order_relaxed) >= 0.5f);
+    dsp.prepare (sampleRate, samplesPerBlock, juce::jmax (getTotalNumInputChannels(), getTotalNumOutputChannels()));
+
+    // Not on the audio thread, so the host hears about the latency before
+    // the first block.
+    updateProcessingMode();
+    setLatencySamples (dsp.getLatencySamples());
 }
 
-void __PLUGIN_NAME__AudioProcessor::prepareToPlay (double, int) {}
 void __PLUGIN_NAME__AudioProcessor::releaseResources() {}
 
 bool __PLUGIN_NAME__AudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
 {
-    return layouts.getMainOutputChannelSet() == juce::AudioChannelSet::stereo();
+    // Every channel is shaped independently, so any layout up to maxChannels
+    // works as long as the input matches the output.
+    const auto& output = layouts.getMainOutputChannelSet();
+
+    return ! output.isDisabled()
+        && output.size() <= maxChannels
+        && layouts.getMainInputChannelSet() == output;
 }
 
 void __PLUGIN_NAME__AudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer&)
+{
+    processSamples (buffer, false);
+}
+
+void __PLUGIN_NAME__AudioProcessor::processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer&)
+{
+    processSamples (buffer, false);
+}
+
+// Only called by hosts that bypass without going through getBypassParameter().
+// Still runs the DSP so the output stays delayed by the reported latency and
+// the switch is crossfaded.
+void __PLUGIN_NAME__AudioProcessor::processBlockBypassed (juce::AudioBuffer<float>& buffer, juce::MidiBuffer&)
+{
+    processSamples (buffer, true);
+}
+
+void __PLUGIN_NAME__AudioProcessor::processBlockBypassed (juce::AudioBuffer<double>& buffer, juce::MidiBuffer&)
+{
+    processSamples (buffer, true);
+}
+
+template <typename SampleType>
+void __PLUGIN_NAME__AudioProcessor::processSamples (juce::AudioBuffer<SampleType>& buffer, bool hostBypassed) noexcept
 {
     juce::ScopedNoDenormals noDenormals;
-    juce::ignoreUnused (buffer);
-    // passthrough
+
+    for (auto channel = getTotalNumInputChannels(); channel < getTotalNumOutputChannels(); ++channel)
+        buffer.clear (channel, 0, buffer.getNumSamples());
+
+    dsp.setDrive (driveParameter->load (std::memory_order_relaxed));
+    dsp.setMix (mixParameter->load (std::memory_order_relaxed) / 100.0f);
+    dsp.setBypassed (hostBypassed || bypassValue->load (std::memory_order_relaxed) >= 0.5f);
+    updateProcessingMode();
+
+    LevelMeterFifo::Frame meterFrame;
+    meterFrame.numSamples = buffer.getNumSamples();
+    meterFrame.input = LevelMeterFifo::measure (buffer, getTotalNumInputChannels());
+
+    // Hosts may send blocks larger than the size given to prepareToPlay, so
+    // the DSP sees them in pieces no longer than the buffers it allocated.
+    const auto numChannels = juce::jmin (buffer.getNumChannels(), dsp.getNumChannels(), maxChannels);
+    const auto chunkSize = juce::jmax (1, dsp.getMaximumBlockSize());
+    std::array<SampleType*, maxChannels> chunk {};
+
+    for (int start = 0; start < buffer.getNumSamples(); start += chunkSize)
+    {
+        for (int channel = 0; channel < numChannels; ++channel)
+            chunk[static_cast<size_t> (channel)] = buffer.getWritePointer (channel, start);
+
+        dsp.process (chunk.data(), numChannels, juce::jmin (chunkSize, buffer.getNumSamples() - start));
+    }
+
+    meterFrame.output = LevelMeterFifo::measure (buffer, getTotalNumOutputChannels());
+    levelMeterFifo.push (meterFrame);
+}
+
+Oversampling::FilterType __PLUGIN_NAME__AudioProcessor::getOversamplingFilterType() const noexcept
+{
+    return oversamplingFilterParameter->load (std::memory_order_relaxed) < 0.5f
+             ? Oversampling::FilterType::linearPhase
+             : Oversampling::FilterType::iir;
+}
+
+void __PLUGIN_NAME__AudioProcessor::updateProcessingMode() noexcept
+{
+    dsp.setOversampling (static_cast<int> (oversamplingParameter->load (std::memory_order_relaxed)), getOversamplingFilterType());
+    dsp.setAntialiasing (antialiasingParameter->load (std::memory_order_relaxed) >= 0.5f);
+    tailLengthSeconds.store (static_cast<double> (dsp.getTailSamples()) / dsp.getSampleRate(), std::memory_order_relaxed);
+}
+
+void __PLUGIN_NAME__AudioProcessor::parameterChanged (const juce::String&, float)
+{
+    // Both raw values are already updated when the listener is called. The
+    // audio thread switches the DSP itself at the start of its next block.
+    const auto factorLog2 = static_cast<int> (oversamplingParameter->load (std::memory_order_relaxed));
+    pendingLatencySamples.store (dsp.getLatencySamples (factorLog2, getOversamplingFilterType()), std::memory_order_relaxed);
+    triggerAsyncUpdate();
+}
+
+void __PLUGIN_NAME__AudioProcessor::handleAsyncUpdate()
+{
+    const auto latency = pendingLatencySamples.load (std::memory_order_relaxed);
+
+    if (latency != getLatencySamples())
+        setLatencySamples (latency);
+}
+
+void __PLUGIN_NAME__AudioProcessor::getStateInformation (juce::MemoryBlock& destData)
+{
+    stateCodec.save (destData);
+}
+
+void __PLUGIN_NAME__AudioProcessor::setStateInformation (const void* data, int sizeInBytes)
+{
+    // Only writes the parameter atomics, so the audio thread never waits on
+    // or allocates for a restore.
+    stateCodec.restore (data, sizeInBytes);
 }
 
 juce::AudioProcessorEditor* __PLUGIN_NAME__AudioProcessor::createEditor()
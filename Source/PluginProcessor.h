@@ -1,16 +1,36 @@
 #pragma once
 #include <JuceHeader.h>
+#include "DSP/PluginDSP.h"
+#include "LevelMeter.h"
+#include "PluginState.h"
 
-class __PLUGIN_NAME__AudioProcessor : public juce::AudioProcessor
+namespace ParamIDs
+{
+    inline constexpr const char* drive = "drive";
+    inline constexpr const char* mix = "mix";
+    inline constexpr const char* oversampling = "oversampling";
+    inline constexpr const char* oversamplingFilter = "oversamplingFilter";
+    inline constexpr const char* antialiasing = "antialiasing";
+    inline constexpr const char* bypass = "bypass";
+}
+
+class __PLUGIN_NAME__AudioProcessor : public juce::AudioProcessor,
+                                     private juce::AudioProcessorValueTreeState::Listener,
+                                     private juce::AsyncUpdater
 {
 public:
     __PLUGIN_NAME__AudioProcessor();
-    ~__PLUGIN_NAME__AudioProcessor() override = default;
+    ~__PLUGIN_NAME__AudioProcessor() override;
 
     void prepareToPlay (double sampleRate, int samplesPerBlock) override;
     void releaseResources() override;
     bool isBusesLayoutSupported (const BusesLayout& layouts) const override;
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    void processBlockBypassed (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlockBypassed (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    juce::AudioProcessorParameter* getBypassParameter() const override { return bypassParameter; }
+    bool supportsDoublePrecisionProcessing() const override { return true; }
 
     juce::AudioProcessorEditor* createEditor() override;
     bool hasEditor() const override { return true; }
@@ -19,7 +39,7 @@ public:
     bool acceptsMidi() const override { return false; }
     bool producesMidi() const override { return false; }
     bool isMidiEffect() const override { return false; }
-    double getTailLengthSeconds() const override { return 0.0; }
+    double getTailLengthSeconds() const override { return tailLengthSeconds.load (std::memory_order_relaxed); }
 
     int getNumPrograms() override { return 1; }
     int getCurrentProgram() override { return 0; }
@@ -27,9 +47,54 @@ public:
     const juce::String getProgramName (int) override { return {}; }
     void changeProgramName (int, const juce::String&) override {}
 
-    void getStateInformation (juce::MemoryBlock&) override {}
-    void setStateInformation (const void*, int) override {}
+    void getStateInformation (juce::MemoryBlock& destData) override;
+    void setStateInformation (const void* data, int sizeInBytes) override;
+
+    static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
+
+    // Widest main bus accepted, enough for 9.1.6.
+    static constexpr int maxChannels = 16;
+
+    juce::AudioProcessorValueTreeState parameters;
+
+    // Filled by processBlock, drained by the editor's meters.
+    LevelMeterFifo& getLevelMeterFifo() noexcept { return levelMeterFifo; }
 
 private:
+    template <typename SampleType>
+    void processSamples (juce::AudioBuffer<SampleType>& buffer, bool hostBypassed) noexcept;
+
+    Oversampling::FilterType getOversamplingFilterType() const noexcept;
+    void updateProcessingMode() noexcept;
+
+    // Oversampling and its filter type set the latency, so changing either
+    // works out the new value here and reports it from handleAsyncUpdate().
+    void parameterChanged (const juce::String& parameterID, float newValue) override;
+    void handleAsyncUpdate() override;
+
+    // Resolved once in the constructor so processBlock never looks parameters
+    // up by ID; the host and GUI write these atomics without locking.
+    std::atomic<float>* driveParameter = nullptr;
+    std::atomic<float>* mixParameter = nullptr;
+    std::atomic<float>* oversamplingParameter = nullptr;
+    std::atomic<float>* oversamplingFilterParameter = nullptr;
+    std::atomic<float>* antialiasingParameter = nullptr;
+    std::atomic<float>* bypassValue = nullptr;
+    juce::AudioProcessorParameter* bypassParameter = nullptr;
+
+    // Written on the audio thread whenever the processing mode changes, read
+    // by the host from any thread.
+    std::atomic<double> tailLengthSeconds { 0.0 };
+
+    // Written by parameterChanged(), which may run on any thread. Reporting
+    // latency locks and allocates inside JUCE and the wrappers, so it waits
+    // for handleAsyncUpdate() on the message thread.
+    std::atomic<int> pendingLatencySamples { 0 };
+
+    PluginStateCodec stateCodec { *this };
+
+    __PLUGIN_NAME__DSP dsp;
+    LevelMeterFifo levelMeterFifo;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (__PLUGIN_NAME__AudioProcessor)
 };
@@ -0,0 +1,176 @@
+#include "PluginState.h"
+
+namespace
+{
+constexpr size_t headerSize = 8;
+constexpr size_t chunkHeaderSize = 12;
+constexpr size_t parameterRecordSize = 8;
+
+juce::uint32 readUInt32 (const juce::uint8* data) noexcept
+{
+    return juce::ByteOrder::littleEndianInt (data);
+}
+
+float readFloat (const juce::uint8* data) noexcept
+{
+    const auto bits = readUInt32 (data);
+    float value;
+    std::memcpy (&value, &bits, sizeof (value));
+    return value;
+}
+
+void writeChunk (juce::MemoryOutputStream& out, juce::uint32 tag, const juce::MemoryBlock& payload)
+{
+    if (payload.getSize() < PluginStateCodec::compressionThreshold)
+    {
+        out.writeInt (static_cast<int> (tag));
+        out.writeInt (0);
+        out.writeInt (static_cast<int> (payload.getSize()));
+        out.write (payload.getData(), payload.getSize());
+        return;
+    }
+
+    juce::MemoryOutputStream compressed;
+    {
+        juce::GZIPCompressorOutputStream gzip (compressed, 9);
+        gzip.write (payload.getData(), payload.getSize());
+    }
+
+    out.writeInt (static_cast<int> (tag));
+    out.writeInt (static_cast<int> (PluginStateCodec::compressedFlag));
+    out.writeInt (static_cast<int> (compressed.getDataSize()));
+    out.write (compressed.getData(), compressed.getDataSize());
+}
+} // namespace
+
+PluginStateCodec::PluginStateCodec (juce::AudioProcessor& processor)
+{
+    for (auto* parameter : processor.getParameters())
+        if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*> (parameter))
+            entries.push_back ({ hashParameterID (ranged->getParameterID()), ranged });
+
+    std::sort (entries.begin(), entries.end(), [] (const Entry& a, const Entry& b) { return a.idHash < b.idHash; });
+
+    for (size_t i = 1; i < entries.size(); ++i)
+        jassert (entries[i - 1].idHash != entries[i].idHash); // two parameter IDs hash alike; rename one
+
+    restoredFlags.resize (entries.size());
+}
+
+juce::uint32 PluginStateCodec::hashParameterID (const juce::String& paramID) noexcept
+{
+    // 32-bit FNV-1a over the UTF-8 bytes: stable across builds and platforms.
+    juce::uint32 hash = 2166136261u;
+    for (auto* c = paramID.toRawUTF8(); *c != 0; ++c)
+    {
+        hash ^= static_cast<juce::uint8> (*c);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+const PluginStateCodec::Entry* PluginStateCodec::findEntry (juce::uint32 idHash) const noexcept
+{
+    const auto it = std::lower_bound (entries.begin(), entries.end(), idHash,
+                                      [] (const Entry& entry, juce::uint32 hash) { return entry.idHash < hash; });
+
+    return (it != entries.end() && it->idHash == idHash) ? &*it : nullptr;
+}
+
+void PluginStateCodec::save (juce::MemoryBlock& destData) const
+{
+    juce::MemoryBlock parameterPayload (4 + entries.size() * parameterRecordSize);
+    {
+        juce::MemoryOutputStream payload (parameterPayload, false);
+        payload.writeInt (static_cast<int> (entries.size()));
+
+        for (const auto& entry : entries)
+        {
+            payload.writeInt (static_cast<int> (entry.idHash));
+            payload.writeFloat (entry.parameter->convertFrom0to1 (entry.parameter->getValue()));
+        }
+    }
+
+    destData.reset();
+    juce::MemoryOutputStream out (destData, false);
+    out.writeInt (static_cast<int> (magic));
+    out.writeShort (static_cast<short> (currentVersion));
+    out.writeShort (1);
+    writeChunk (out, parametersTag, parameterPayload);
+}
+
+bool PluginStateCodec::restore (const void* data, int sizeInBytes)
+{
+    if (data == nullptr || sizeInBytes < static_cast<int> (headerSize))
+        return false;
+
+    const auto* bytes = static_cast<const juce::uint8*> (data);
+    const auto size = static_cast<size_t> (sizeInBytes);
+
+    if (readUInt32 (bytes) != magic)
+        return false;
+
+    // Newer versions only ever add chunks, so they are read as far as understood.
+    const auto numChunks = juce::ByteOrder::littleEndianShort (bytes + 6);
+    size_t offset = headerSize;
+
+    for (int chunk = 0; chunk < numChunks; ++chunk)
+    {
+        if (size - offset < chunkHeaderSize)
+            return false;
+
+        const auto tag = readUInt32 (bytes + offset);
+        const auto flags = readUInt32 (bytes + offset + 4);
+        const auto chunkSize = static_cast<size_t> (readUInt32 (bytes + offset + 8));
+        offset += chunkHeaderSize;
+
+        if (size - offset < chunkSize)
+            return false;
+
+        const auto* payload = bytes + offset;
+        offset += chunkSize;
+
+        if (tag != parametersTag)
+            continue;
+
+        if ((flags & compressedFlag) == 0)
+        {
+            restoreParameters (payload, chunkSize);
+            continue;
+        }
+
+        juce::MemoryInputStream compressed (payload, chunkSize, false);
+        juce::GZIPDecompressorInputStream gzip (compressed);
+        juce::MemoryBlock decompressed;
+        gzip.readIntoMemoryBlock (decompressed);
+        restoreParameters (static_cast<const juce::uint8*> (decompressed.getData()), decompressed.getSize());
+    }
+
+    return true;
+}
+
+void PluginStateCodec::restoreParameters (const juce::uint8* payload, size_t size)
+{
+    if (size < 4)
+        return;
+
+    std::fill (restoredFlags.begin(), restoredFlags.end(), false);
+
+    const auto count = std::min (static_cast<size_t> (readUInt32 (payload)), (size - 4) / parameterRecordSize);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const auto* record = payload + 4 + i * parameterRecordSize;
+
+        if (const auto* entry = findEntry (readUInt32 (record)))
+        {
+            auto& parameter = *entry->parameter;
+            parameter.setValueNotifyingHost (parameter.convertTo0to1 (readFloat (record + 4)));
+            restoredFlags[static_cast<size_t> (entry - entries.data())] = true;
+        }
+    }
+
+    for (size_t i = 0; i < entries.size(); ++i)
+        if (! restoredFlags[i])
+            entries[i].parameter->setValueNotifyingHost (entries[i].parameter->getDefaultValue());
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <JuceHeader.h>
+
+// Binary plugin state: a small header followed by tagged chunks.
+//
+//   uint32 magic 'PSTA', uint16 version, uint16 numChunks
+//   per chunk: uint32 tag, uint32 flags, uint32 size, size bytes of payload
+//
+// All integers are little-endian. The parameter chunk ('PRMS') holds a count
+// and then one { uint32 ID hash, float32 plain value } record per parameter,
+// so restoring is a binary search per record with no XML or ValueTree work.
+// Chunks at or above compressionThreshold bytes are stored gzip-compressed
+// (flag bit 0). Unknown chunks and parameter IDs are skipped, and parameters
+// missing from the blob go back to their defaults.
+class PluginStateCodec
+{
+public:
+    explicit PluginStateCodec (juce::AudioProcessor& processor);
+
+    void save (juce::MemoryBlock& destData) const;
+    bool restore (const void* data, int sizeInBytes);
+
+    static juce::uint32 hashParameterID (const juce::String& paramID) noexcept;
+
+    static constexpr juce::uint32 magic = 0x41545350; // "PSTA"
+    static constexpr juce::uint16 currentVersion = 1;
+    static constexpr juce::uint32 parametersTag = 0x534d5250; // "PRMS"
+    static constexpr juce::uint32 compressedFlag = 1;
+    static constexpr size_t compressionThreshold = 4096;
+
+private:
+    struct Entry
+    {
+        juce::uint32 idHash = 0;
+        juce::RangedAudioParameter* parameter = nullptr;
+    };
+
+    const Entry* findEntry (juce::uint32 idHash) const noexcept;
+    void restoreParameters (const juce::uint8* payload, size_t size);
+
+    std::vector<Entry> entries;
+    std::vector<bool> restoredFlags;
+
+    JUCE_DECLARE_NON_COPYABLE (PluginStateCodec)
+};
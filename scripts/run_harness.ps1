@@ -96,8 +96,12 @@ try {
     $runOutDir = Join-Path $artifactsRoot $timestamp
     New-Item -ItemType Directory -Force -Path $runOutDir | Out-Null
 
-    Invoke-Step "Generate test WAVs" {
-        python scripts/gen_test_wavs.py --outdir $generatedDir --sr 48000 --seconds 2.0 --channels 2
+    Invoke-Step "Generate impulse" {
+        & $harness.FullName generate --type impulse --out (Join-Path $generatedDir "impulse.wav") --sr 48000 --seconds 2.0 --ch 2
+    }
+
+    Invoke-Step "Generate 1 kHz sine" {
+        & $harness.FullName generate --type sine --freq 1000 --out (Join-Path $generatedDir "sine1k.wav") --sr 48000 --seconds 2.0 --ch 2
     }
 
     Invoke-Step "Dump plugin params" {
@@ -0,0 +1,526 @@
+// Native microbenchmark for __PLUGIN_NAME__DSP. Links the DSP library directly,
+// so measuring a change needs neither a VST3 bundle nor a plugin host.
+
+#include "DSP/PluginDSP.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_IX86)
+ #include <xmmintrin.h>
+ #define DSP_BENCH_HAS_SSE 1
+#else
+ #define DSP_BENCH_HAS_SSE 0
+#endif
+
+namespace
+{
+// How the waveshaper is anti-aliased: plain tanh, ADAA, and/or oversampling.
+struct ShaperMode
+{
+    std::string name;
+    int factorLog2 = 0;
+    Oversampling::FilterType filterType = Oversampling::FilterType::linearPhase;
+    bool antiderivative = false;
+};
+
+struct BenchOptions
+{
+    double sampleRate = 48000.0;
+    double seconds = 1.0;
+    std::vector<int> channelCounts { 1, 2, 6, 8 };
+    std::vector<int> blockSizes { 32, 64, 128, 256, 512, 1024 };
+    double automationHz = 0.0;
+    double aliasingHz = 5000.0;
+    std::vector<ShaperMode> modes;
+    std::string jsonPath;
+};
+
+struct BenchResult
+{
+    std::string mode;
+    double aliasingDb = 0.0;
+    int channels = 0;
+    int blockSize = 0;
+    std::int64_t numBlocks = 0;
+    double meanUs = 0.0;
+    double medianUs = 0.0;
+    double p99Us = 0.0;
+    double maxUs = 0.0;
+    double nsPerSample = 0.0;
+    double realtimeFactor = 0.0;
+};
+
+void printUsage()
+{
+    std::cout
+        << "__PLUGIN_NAME___bench usage:\n"
+        << "  __PLUGIN_NAME___bench [--sr <hz>] [--seconds <s>] [--ch <n,n,...>] [--bs <n,n,...>] [--automate <hz>]\n"
+        << "                        [--modes <mode,mode,...>] [--alias-hz <hz>] [--json <file>]\n"
+        << "\n"
+        << "Times __PLUGIN_NAME__DSP::process for every mode / channel count / block size combination.\n"
+        << "--automate moves every parameter to a new value at the given rate (applied at block starts, as a host would).\n"
+        << "Modes: tanh, adaa, os2, os4, os8 (linear-phase oversampling), os2-iir, os4-iir, os8-iir,\n"
+        << "and adaa-os2 etc. to combine both. Each mode also reports aliasing: the power folded back\n"
+        << "below Nyquist, relative to the fundamental, for a sine at --alias-hz driven at full Drive.\n"
+        << "Defaults: --sr 48000 --seconds 1 --ch 1,2,6,8 --bs 32,64,128,256,512,1024 --modes tanh --alias-hz 5000\n";
+}
+
+bool parseIntStrict(const std::string& text, int& outValue)
+{
+    try
+    {
+        size_t consumed = 0;
+        const int value = std::stoi(text, &consumed);
+        if (consumed != text.size())
+            return false;
+
+        outValue = value;
+        return true;
+    }
+    catch (...)
+    {
+        return false;
+    }
+}
+
+bool parseDoubleStrict(const std::string& text, double& outValue)
+{
+    try
+    {
+        size_t consumed = 0;
+        const double value = std::stod(text, &consumed);
+        if (consumed != text.size() || !std::isfinite(value))
+            return false;
+
+        outValue = value;
+        return true;
+    }
+    catch (...)
+    {
+        return false;
+    }
+}
+
+bool parsePositiveIntList(const std::string& text, std::vector<int>& outValues)
+{
+    std::vector<int> values;
+    size_t start = 0;
+
+    while (start <= text.size())
+    {
+        const size_t comma = std::min(text.find(',', start), text.size());
+        int value = 0;
+        if (!parseIntStrict(text.substr(start, comma - start), value) || value <= 0)
+            return false;
+
+        values.push_back(value);
+        start = comma + 1;
+    }
+
+    outValues = values;
+    return !outValues.empty();
+}
+
+bool parseShaperMode(const std::string& name, ShaperMode& outMode)
+{
+    ShaperMode mode;
+    mode.name = name;
+    std::string rest = name;
+
+    if (rest.rfind("adaa", 0) == 0)
+    {
+        mode.antiderivative = true;
+        rest = rest.substr(4);
+        if (rest.empty())
+        {
+            outMode = mode;
+            return true;
+        }
+
+        if (rest[0] != '-')
+            return false;
+
+        rest = rest.substr(1);
+    }
+    else if (rest == "tanh")
+    {
+        outMode = mode;
+        return true;
+    }
+
+    if (rest.size() > 4 && rest.compare(rest.size() - 4, 4, "-iir") == 0)
+    {
+        mode.filterType = Oversampling::FilterType::iir;
+        rest = rest.substr(0, rest.size() - 4);
+    }
+
+    if (rest == "os2")
+        mode.factorLog2 = 1;
+    else if (rest == "os4")
+        mode.factorLog2 = 2;
+    else if (rest == "os8")
+        mode.factorLog2 = 3;
+    else
+        return false;
+
+    outMode = mode;
+    return true;
+}
+
+bool parseShaperModeList(const std::string& text, std::vector<ShaperMode>& outModes)
+{
+    std::vector<ShaperMode> modes;
+    size_t start = 0;
+
+    while (start <= text.size())
+    {
+        const size_t comma = std::min(text.find(',', start), text.size());
+        ShaperMode mode;
+        if (!parseShaperMode(text.substr(start, comma - start), mode))
+            return false;
+
+        modes.push_back(mode);
+        start = comma + 1;
+    }
+
+    outModes = modes;
+    return !outModes.empty();
+}
+
+bool parseOptions(int argc, char* argv[], BenchOptions& options, std::string& error)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string key(argv[i]);
+        if (i + 1 >= argc)
+        {
+            error = "Missing value for " + key;
+            return false;
+        }
+
+        const std::string value(argv[++i]);
+        bool ok = true;
+
+        if (key == "--sr")
+            ok = parseDoubleStrict(value, options.sampleRate) && options.sampleRate > 0.0;
+        else if (key == "--seconds")
+            ok = parseDoubleStrict(value, options.seconds) && options.seconds > 0.0;
+        else if (key == "--ch")
+            ok = parsePositiveIntList(value, options.channelCounts);
+        else if (key == "--bs")
+            ok = parsePositiveIntList(value, options.blockSizes);
+        else if (key == "--automate")
+            ok = parseDoubleStrict(value, options.automationHz) && options.automationHz >= 0.0;
+        else if (key == "--modes")
+            ok = parseShaperModeList(value, options.modes);
+        else if (key == "--alias-hz")
+            ok = parseDoubleStrict(value, options.aliasingHz) && options.aliasingHz > 0.0;
+        else if (key == "--json")
+            options.jsonPath = value;
+        else
+        {
+            error = "Unknown option: " + key;
+            return false;
+        }
+
+        if (!ok)
+        {
+            error = "Invalid value for " + key + ": " + value;
+            return false;
+        }
+    }
+
+    if (options.aliasingHz >= 0.5 * options.sampleRate)
+    {
+        error = "--alias-hz must be below Nyquist";
+        return false;
+    }
+
+    if (options.modes.empty())
+        parseShaperModeList("tanh", options.modes);
+
+    return true;
+}
+
+// Matches the flush-to-zero mode juce::ScopedNoDenormals sets in the plugin, so
+// denormal-heavy tails cost the same here as in a host.
+void disableDenormals()
+{
+   #if DSP_BENCH_HAS_SSE
+    _mm_setcsr(_mm_getcsr() | 0x8040);
+   #endif
+}
+
+double percentileOfSorted(const std::vector<double>& sorted, double fraction)
+{
+    const auto rank = static_cast<size_t>(std::ceil(fraction * static_cast<double>(sorted.size())));
+    return sorted[std::min(sorted.size() - 1, rank > 0 ? rank - 1 : 0)];
+}
+
+void applyShaperMode(__PLUGIN_NAME__DSP& dsp, const ShaperMode& mode)
+{
+    dsp.setOversampling(mode.factorLog2, mode.filterType);
+    dsp.setAntialiasing(mode.antiderivative);
+}
+
+// Power of bin k of an N-point DFT as the mean-square of that sinusoid, via
+// the Goertzel recurrence.
+double binPower(const std::vector<float>& samples, std::int64_t bin)
+{
+    const double pi = 3.14159265358979323846;
+    const double n = static_cast<double>(samples.size());
+    const double coefficient = 2.0 * std::cos(2.0 * pi * static_cast<double>(bin) / n);
+    double s1 = 0.0;
+    double s2 = 0.0;
+
+    for (const float sample : samples)
+    {
+        const double s0 = static_cast<double>(sample) + coefficient * s1 - s2;
+        s2 = s1;
+        s1 = s0;
+    }
+
+    const double magnitudeSquared = s1 * s1 + s2 * s2 - coefficient * s1 * s2;
+    return 2.0 * magnitudeSquared / (n * n);
+}
+
+// Drives a sine through the DSP at full Drive and reports the power of every
+// component that is not DC, the fundamental or a harmonic below Nyquist,
+// relative to the fundamental. The sine sits exactly on an odd DFT bin, so the
+// output is periodic in the analysis window and no window function is needed;
+// with an odd bin, folded harmonics never land on true harmonic bins.
+double measureAliasingDb(const BenchOptions& options, const ShaperMode& mode)
+{
+    constexpr std::int64_t numAnalysisSamples = 1 << 16;
+    constexpr int blockSize = 512;
+
+    auto bin = static_cast<std::int64_t>(std::llround(options.aliasingHz * static_cast<double>(numAnalysisSamples) / options.sampleRate));
+    bin |= 1;
+
+    __PLUGIN_NAME__DSP dsp;
+    dsp.setDrive(24.0f);
+    dsp.setMix(1.0f);
+    applyShaperMode(dsp, mode);
+    dsp.prepare(options.sampleRate, blockSize, 1);
+
+    // One full period of warm-up covers the latency and any filter settling.
+    std::vector<float> output;
+    output.reserve(static_cast<size_t>(numAnalysisSamples));
+    std::vector<float> block(static_cast<size_t>(blockSize));
+    const double pi = 3.14159265358979323846;
+
+    for (std::int64_t start = 0; start < 2 * numAnalysisSamples; start += blockSize)
+    {
+        for (int i = 0; i < blockSize; ++i)
+        {
+            const auto index = (start + i) % numAnalysisSamples;
+            block[static_cast<size_t>(i)] = static_cast<float>(0.5 * std::sin(2.0 * pi * static_cast<double>(bin * index) / static_cast<double>(numAnalysisSamples)));
+        }
+
+        float* pointers[] = { block.data() };
+        dsp.process(pointers, 1, blockSize);
+
+        if (start >= numAnalysisSamples)
+            output.insert(output.end(), block.begin(), block.end());
+    }
+
+    double sum = 0.0;
+    double sumSquares = 0.0;
+    for (const float sample : output)
+    {
+        sum += static_cast<double>(sample);
+        sumSquares += static_cast<double>(sample) * static_cast<double>(sample);
+    }
+
+    const double mean = sum / static_cast<double>(output.size());
+    double remainingPower = sumSquares / static_cast<double>(output.size()) - mean * mean;
+    const double fundamentalPower = binPower(output, bin);
+
+    for (std::int64_t harmonicBin = bin; 2 * harmonicBin < numAnalysisSamples; harmonicBin += bin)
+        remainingPower -= binPower(output, harmonicBin);
+
+    return 10.0 * std::log10(std::max(remainingPower, 1.0e-30) / fundamentalPower);
+}
+
+BenchResult runBenchCase(const BenchOptions& options, const ShaperMode& mode, int channels, int blockSize)
+{
+    __PLUGIN_NAME__DSP dsp;
+    applyShaperMode(dsp, mode);
+    dsp.prepare(options.sampleRate, blockSize, channels);
+
+    // The same noise block is copied in before every call, outside the timed
+    // region, so each call sees realistic input rather than its own output.
+    std::uint32_t seed = 0x5eedu;
+    std::vector<std::vector<float>> source(static_cast<size_t>(channels), std::vector<float>(static_cast<size_t>(blockSize)));
+    for (auto& channel : source)
+    {
+        for (auto& sample : channel)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            sample = 0.25f * (static_cast<float>(seed >> 8) / 8388608.0f - 1.0f);
+        }
+    }
+
+    std::vector<std::vector<float>> io(source);
+    std::vector<float*> pointers;
+    for (auto& channel : io)
+        pointers.push_back(channel.data());
+
+    const auto totalSamples = static_cast<std::int64_t>(std::llround(options.seconds * options.sampleRate));
+    const auto numBlocks = std::max<std::int64_t>(1, (totalSamples + blockSize - 1) / blockSize);
+    const auto warmupBlocks = std::max<std::int64_t>(1, numBlocks / 20);
+
+    std::vector<double> blockMicros;
+    blockMicros.reserve(static_cast<size_t>(numBlocks));
+
+    // Parameter changes happen outside the timed region, like the processor
+    // reading its parameter atomics before calling process().
+    const double samplesPerChange = options.automationHz > 0.0 ? options.sampleRate / options.automationHz : 0.0;
+    double nextChange = 0.0;
+    std::uint32_t automationSeed = 0xa070u;
+
+    for (std::int64_t block = 0; block < warmupBlocks + numBlocks; ++block)
+    {
+        const double blockStart = static_cast<double>(block * blockSize);
+        if (samplesPerChange > 0.0 && blockStart >= nextChange)
+        {
+            automationSeed = automationSeed * 1664525u + 1013904223u;
+            const float amount = static_cast<float>(automationSeed >> 8) / 16777216.0f;
+            dsp.setDrive(24.0f * amount);
+            dsp.setMix(1.0f - amount);
+
+            while (nextChange <= blockStart)
+                nextChange += samplesPerChange;
+        }
+
+        for (int channel = 0; channel < channels; ++channel)
+            std::copy(source[static_cast<size_t>(channel)].begin(), source[static_cast<size_t>(channel)].end(), io[static_cast<size_t>(channel)].begin());
+
+        const auto start = std::chrono::steady_clock::now();
+        dsp.process(pointers.data(), channels, blockSize);
+        const auto end = std::chrono::steady_clock::now();
+
+        if (block >= warmupBlocks)
+            blockMicros.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+    }
+
+    std::vector<double> sorted(blockMicros);
+    std::sort(sorted.begin(), sorted.end());
+
+    double totalMicros = 0.0;
+    for (const double micros : sorted)
+        totalMicros += micros;
+
+    BenchResult result;
+    result.mode = mode.name;
+    result.channels = channels;
+    result.blockSize = blockSize;
+    result.numBlocks = static_cast<std::int64_t>(sorted.size());
+    result.meanUs = totalMicros / static_cast<double>(sorted.size());
+    result.medianUs = percentileOfSorted(sorted, 0.5);
+    result.p99Us = percentileOfSorted(sorted, 0.99);
+    result.maxUs = sorted.back();
+    result.nsPerSample = 1000.0 * result.meanUs / (static_cast<double>(blockSize) * static_cast<double>(channels));
+
+    const double blockDurationMicros = 1.0e6 * static_cast<double>(blockSize) / options.sampleRate;
+    result.realtimeFactor = result.meanUs > 0.0 ? blockDurationMicros / result.meanUs : 0.0;
+    return result;
+}
+
+bool writeJson(const std::string& path, const BenchOptions& options, const std::vector<BenchResult>& results)
+{
+    std::ofstream stream(path);
+    if (!stream)
+        return false;
+
+    stream << "{\n"
+           << "  \"sampleRate\": " << options.sampleRate << ",\n"
+           << "  \"seconds\": " << options.seconds << ",\n"
+           << "  \"automationHz\": " << options.automationHz << ",\n"
+           << "  \"aliasingHz\": " << options.aliasingHz << ",\n"
+           << "  \"results\": [\n";
+
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const auto& result = results[i];
+        stream << "    { \"mode\": \"" << result.mode << "\""
+               << ", \"aliasingDb\": " << result.aliasingDb
+               << ", \"channels\": " << result.channels
+               << ", \"blockSize\": " << result.blockSize
+               << ", \"numBlocks\": " << result.numBlocks
+               << ", \"meanUs\": " << result.meanUs
+               << ", \"medianUs\": " << result.medianUs
+               << ", \"p99Us\": " << result.p99Us
+               << ", \"maxUs\": " << result.maxUs
+               << ", \"nsPerSample\": " << result.nsPerSample
+               << ", \"realtimeFactor\": " << result.realtimeFactor
+               << " }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+
+    stream << "  ]\n}\n";
+    return static_cast<bool>(stream);
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    if (argc > 1 && (std::string(argv[1]) == "--help" || std::string(argv[1]) == "-h"))
+    {
+        printUsage();
+        return 0;
+    }
+
+    BenchOptions options;
+    std::string error;
+    if (!parseOptions(argc, argv, options, error))
+    {
+        std::cerr << "Error: " << error << "\n";
+        return 1;
+    }
+
+    disableDenormals();
+
+    std::vector<BenchResult> results;
+    std::cout << "mode\talias dB\tch\tbs\tmean us\tmedian us\tp99 us\tmax us\tns/sample\trealtime x\n";
+
+    for (const auto& mode : options.modes)
+    {
+        const double aliasingDb = measureAliasingDb(options, mode);
+
+        for (const int channels : options.channelCounts)
+        {
+            for (const int blockSize : options.blockSizes)
+            {
+                auto result = runBenchCase(options, mode, channels, blockSize);
+                result.aliasingDb = aliasingDb;
+                results.push_back(result);
+
+                std::cout << result.mode << "\t" << result.aliasingDb << "\t"
+                          << result.channels << "\t" << result.blockSize << "\t"
+                          << result.meanUs << "\t" << result.medianUs << "\t"
+                          << result.p99Us << "\t" << result.maxUs << "\t"
+                          << result.nsPerSample << "\t" << result.realtimeFactor << "\n";
+            }
+        }
+    }
+
+    if (!options.jsonPath.empty())
+    {
+        if (!writeJson(options.jsonPath, options, results))
+        {
+            std::cerr << "Error: Failed to write " << options.jsonPath << "\n";
+            return 1;
+        }
+
+        std::cout << "Wrote: " << options.jsonPath << "\n";
+    }
+
+    return 0;
+}
@@ -1,17 +1,41 @@
 #include <juce_audio_formats/juce_audio_formats.h>
 #include <juce_audio_processors/juce_audio_processors.h>
+#include <juce_dsp/juce_dsp.h>
 #include <juce_gui_basics/juce_gui_basics.h>
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cmath>
+#include <complex>
+#include <condition_variable>
 #include <cstdint>
+#include <cstdio>
+#include <cstdlib>
 #include <iostream>
 #include <limits>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
+#include <thread>
 #include <vector>
 
+#include "rt_check.h"
+
+#if JUCE_LINUX
+ #include <cxxabi.h>
+ #include <dlfcn.h>
+#endif
+
+#if JUCE_WINDOWS
+ #include <fcntl.h>
+ #include <io.h>
+#else
+ #include <unistd.h>
+#endif
+
 namespace
 {
 using OptionMap = std::map<std::string, std::string>;
@@ -22,12 +46,60 @@ struct AudioData
     double sampleRate = 0.0;
 };
 
+enum class AutomationCurve
+{
+    linear,
+    step
+};
+
+struct AutomationPoint
+{
+    double seconds = 0.0;
+    float value = 0.0f;
+};
+
+struct AutomationLaneSpec
+{
+    std::optional<std::string> nameLowercase;
+    std::optional<int> index;
+    AutomationCurve curve = AutomationCurve::linear;
+    std::vector<AutomationPoint> points;
+};
+
+struct SweepAxisSpec
+{
+    std::optional<std::string> nameLowercase;
+    std::optional<int> index;
+    std::vector<float> values;
+};
+
 struct RenderCase
 {
+    std::optional<juce::String> plugin;
+    std::optional<juce::String> input;
+    std::optional<int> sampleRate;
+    std::optional<int> blockSize;
+    std::optional<int> channels;
     int warmupMs = 50;
     std::optional<double> renderSeconds;
     std::map<std::string, float> paramsByName;
     std::map<int, float> paramsByIndex;
+    std::vector<AutomationLaneSpec> automation;
+    int automationIntervalSamples = 32;
+    std::vector<SweepAxisSpec> sweep;
+};
+
+struct PluginCacheOptions
+{
+    bool enabled = true;
+    juce::File file;
+};
+
+struct PluginFingerprint
+{
+    juce::String path;
+    juce::int64 modificationTime = 0;
+    juce::int64 totalBytes = 0;
 };
 
 struct LevelMetrics
@@ -36,6 +108,45 @@ struct LevelMetrics
     double rmsDbfs = -160.0;
 };
 
+struct RenderStats
+{
+    juce::int64 numSamples = 0;
+    double peak = 0.0;
+    double sumSquares = 0.0;
+    bool hasNaNOrInf = false;
+};
+
+struct AutomationBreakpoint
+{
+    juce::int64 position = 0;
+    float value = 0.0f;
+};
+
+struct AutomationLane
+{
+    juce::AudioProcessorParameter* parameter = nullptr;
+    AutomationCurve curve = AutomationCurve::linear;
+    std::vector<AutomationBreakpoint> breakpoints;
+    float lastSentValue = -1.0f;
+};
+
+struct Automation
+{
+    std::vector<AutomationLane> lanes;
+    int intervalSamples = 32;
+};
+
+// Entry points of the realtime-safety shim. All null unless --rt-check is
+// given, in which case processBlock calls are bracketed with begin/end.
+struct RtCheck
+{
+    RtCheckBeginFn begin = nullptr;
+    RtCheckEndFn end = nullptr;
+    RtCheckGetSitesFn getSites = nullptr;
+
+    bool isEnabled() const { return begin != nullptr; }
+};
+
 void printUsage()
 {
     std::cout
@@ -43,8 +154,49 @@ void printUsage()
         << "  vst3_harness --help\n"
         << "  vst3_harness --version\n"
         << "  vst3_harness dump-params --plugin <path_to.vst3>\n"
-        << "  vst3_harness render --plugin <path.vst3> --in <dry.wav> --outdir <dir> --sr <hz> --bs <samples> --ch <channels> [--case <case.json>]\n"
-        << "  vst3_harness analyze --dry <dry.wav> --wet <wet.wav> --outdir <dir> [--auto-align] [--null]\n";
+        << "  vst3_harness render --plugin <path.vst3> --in <dry.wav> --outdir <dir> --sr <hz> --bs <samples> --ch <channels|layout> [--case <case.json>] [--precision float|double] [--format 16|24|32f|raw] [--rt-check]\n"
+        << "  vst3_harness run-suite --cases <dir> --outdir <dir> [--jobs <n>] [--plugin <path.vst3>] [--in <dry.wav>] [--sr <hz>] [--bs <samples>] [--ch <channels|layout>]\n"
+        << "  vst3_harness sweep --case <case.json> --outdir <dir> [--jobs <n>] [--plugin <path.vst3>] [--in <dry.wav>] [--sr <hz>] [--bs <samples>] [--ch <channels|layout>]\n"
+        << "  vst3_harness bench --plugin <path.vst3> --outdir <dir> --sr <hz> --bs <samples> --ch <channels|layout> [--in <dry.wav> | --sparse <fraction>] [--seconds <s>] [--case <case.json>] [--rt-check]\n"
+        << "  vst3_harness state-bench --plugin <path.vst3> --outdir <dir> [--iterations <n>] [--case <case.json>]\n"
+        << "  vst3_harness analyze --dry <dry.wav> --wet <wet.wav> --outdir <dir> [--auto-align] [--max-lag <samples>] [--null]\n"
+        << "  vst3_harness analyze --ir --dry <sweep.wav> --wet <wet.wav> --outdir <dir> [--f-start <hz>] [--f-end <hz>] [--harmonics <n>] [--ir-length <samples>]\n"
+        << "  vst3_harness stream --plugin <path.vst3> --sr <hz> --bs <samples> --ch <channels|layout> [--case <case.json>]\n"
+        << "  vst3_harness generate --type <impulse|sine|sweep|white|pink|multitone> --out <file.wav> --sr <hz> --ch <channels|layout>\n"
+        << "                        [--seconds <s>] [--level <dBFS>] [--freq <hz>] [--freqs <hz,hz,...>] [--f-start <hz>] [--f-end <hz>] [--seed <n>]\n"
+        << "\n"
+        << "Subcommands that load a plugin also accept:\n"
+        << "  --no-cache               always rescan the plugin instead of using the description cache\n"
+        << "  --plugin-cache <file>    description cache location (default: <user app data>/vst3_harness/plugin_cache.xml)\n"
+        << "\n"
+        << "render and bench also accept:\n"
+        << "  --rt-check               report allocations and mutex locks made inside processBlock to rt_check.json\n"
+        << "                           and exit with code 3 if there were any (Linux only; warm-up blocks are not checked)\n"
+        << "\n"
+        << "--ch takes a channel count (1 is mono, 2 stereo, more are discrete channels) or a layout name:\n"
+        << "  mono, stereo, lcr, quad, 5.0, 5.1, 6.1, 7.0, 7.1, 5.1.2, 5.1.4, 7.1.2, 7.1.4, 7.1.6, 9.1.6\n"
+        << "\n"
+        << "render --format picks the wet output: 16- or 24-bit (default) PCM or 32-bit float WAV, or raw\n"
+        << "interleaved little-endian float32 (wet.raw). Conversion and disk writes run on a background thread.\n"
+        << "\n"
+        << "render --precision double processes in double precision and also renders the case in float,\n"
+        << "writing the difference between the two and their processing times to precision.json.\n"
+        << "\n"
+        << "generate streams the signal to a 24-bit WAV (default 2 s). --level is the peak level (default -6 dBFS,\n"
+        << "-1 dBFS for impulse; multitone splits it evenly between tones; pink noise matches white noise RMS).\n"
+        << "sine defaults to --freq 1000, multitone to --freqs 100,1000,5000, sweep to 20 Hz..20 kHz. Noise channels\n"
+        << "are independent; other signals are identical on every channel.\n"
+        << "\n"
+        << "stream reads interleaved little-endian float32 from stdin and writes the processed audio to stdout in\n"
+        << "the same format and length, one --bs block at a time. Messages go to stderr.\n"
+        << "\n"
+        << "analyze --ir deconvolves a wet render of a generate --type sweep file (pass the same --f-start/--f-end)\n"
+        << "into the linear impulse response and the responses of harmonics 2..--harmonics (default 5). It writes\n"
+        << "ir.wav (32-bit float, one IR per channel, --ir-length default 8192) and ir.json with the frequency\n"
+        << "response, harmonic levels in dBc and THD at 1/12-octave points across the sweep.\n"
+        << "\n"
+        << "bench without --in runs on generated noise. --sparse keeps that noise on for the given fraction of\n"
+        << "each second and silent otherwise; bench.json then compares blocks with silent and active input.\n";
 }
 
 int fail(const juce::String& message)
@@ -114,6 +266,23 @@ bool parseIntStrict(const std::string& text, int& outValue)
     }
 }
 
+bool parseDoubleStrict(const std::string& text, double& outValue)
+{
+    try
+    {
+        size_t endIndex = 0;
+        const double value = std::stod(text, &endIndex);
+        if (endIndex != text.size() || !std::isfinite(value))
+            return false;
+        outValue = value;
+        return true;
+    }
+    catch (...)
+    {
+        return false;
+    }
+}
+
 bool getRequiredOption(const OptionMap& options,
                        const char* key,
                        juce::String& outValue,
@@ -160,6 +329,145 @@ bool getRequiredIntOption(const OptionMap& options,
     return true;
 }
 
+bool getOptionalIntOption(const OptionMap& options,
+                          const char* key,
+                          std::optional<int>& outValue,
+                          juce::String& error)
+{
+    if (options.find(key) == options.end())
+        return true;
+
+    int parsed = 0;
+    if (!getRequiredIntOption(options, key, parsed, error))
+        return false;
+
+    outValue = parsed;
+    return true;
+}
+
+bool getOptionalDoubleOption(const OptionMap& options,
+                             const char* key,
+                             std::optional<double>& outValue,
+                             juce::String& error)
+{
+    juce::String rawValue;
+    if (!getOptionalOption(options, key, rawValue))
+        return true;
+
+    double parsed = 0.0;
+    if (!parseDoubleStrict(rawValue.toStdString(), parsed))
+    {
+        error = "Invalid numeric value for --" + juce::String(key) + ": " + rawValue;
+        return false;
+    }
+
+    outValue = parsed;
+    return true;
+}
+
+juce::AudioChannelSet makeChannelSet(int channels)
+{
+    if (channels <= 1)
+        return juce::AudioChannelSet::mono();
+    if (channels == 2)
+        return juce::AudioChannelSet::stereo();
+    return juce::AudioChannelSet::discreteChannels(channels);
+}
+
+// --ch takes a channel count (mono, stereo, or that many discrete channels) or
+// the name of a standard layout.
+bool parseChannelLayout(const juce::String& text, juce::AudioChannelSet& outLayout, juce::String& error)
+{
+    int count = 0;
+    if (parseIntStrict(text.toStdString(), count))
+    {
+        if (count <= 0)
+        {
+            error = "Channel count must be positive: " + text;
+            return false;
+        }
+
+        outLayout = makeChannelSet(count);
+        return true;
+    }
+
+    struct NamedLayout
+    {
+        const char* name;
+        juce::AudioChannelSet layout;
+    };
+
+    const NamedLayout namedLayouts[] = {
+        { "mono", juce::AudioChannelSet::mono() },
+        { "stereo", juce::AudioChannelSet::stereo() },
+        { "lcr", juce::AudioChannelSet::createLCR() },
+        { "quad", juce::AudioChannelSet::quadraphonic() },
+        { "5.0", juce::AudioChannelSet::create5point0() },
+        { "5.1", juce::AudioChannelSet::create5point1() },
+        { "6.1", juce::AudioChannelSet::create6point1() },
+        { "7.0", juce::AudioChannelSet::create7point0() },
+        { "7.1", juce::AudioChannelSet::create7point1() },
+        { "5.1.2", juce::AudioChannelSet::create5point1point2() },
+        { "5.1.4", juce::AudioChannelSet::create5point1point4() },
+        { "7.1.2", juce::AudioChannelSet::create7point1point2() },
+        { "7.1.4", juce::AudioChannelSet::create7point1point4() },
+        { "7.1.6", juce::AudioChannelSet::create7point1point6() },
+        { "9.1.6", juce::AudioChannelSet::create9point1point6() },
+    };
+
+    juce::StringArray names;
+    for (const auto& named : namedLayouts)
+    {
+        if (text.equalsIgnoreCase(named.name))
+        {
+            outLayout = named.layout;
+            return true;
+        }
+
+        names.add(named.name);
+    }
+
+    error = "Unknown channel layout: " + text + " (use a channel count or one of " + names.joinIntoString(", ") + ")";
+    return false;
+}
+
+bool getOptionalChannelLayoutOption(const OptionMap& options,
+                                    const char* key,
+                                    std::optional<juce::AudioChannelSet>& outLayout,
+                                    juce::String& error)
+{
+    juce::String rawValue;
+    if (!getOptionalOption(options, key, rawValue))
+        return true;
+
+    juce::AudioChannelSet layout;
+    if (!parseChannelLayout(rawValue, layout, error))
+    {
+        error = "Invalid value for --" + juce::String(key) + ": " + error;
+        return false;
+    }
+
+    outLayout = layout;
+    return true;
+}
+
+bool getRequiredChannelLayoutOption(const OptionMap& options,
+                                    const char* key,
+                                    juce::AudioChannelSet& outLayout,
+                                    juce::String& error)
+{
+    juce::String rawValue;
+    if (!getRequiredOption(options, key, rawValue, error))
+        return false;
+
+    std::optional<juce::AudioChannelSet> layout;
+    if (!getOptionalChannelLayoutOption(options, key, layout, error))
+        return false;
+
+    outLayout = layout.value();
+    return true;
+}
+
 bool getFlag(const OptionMap& options, const char* key)
 {
     return options.find(key) != options.end();
@@ -193,47 +501,106 @@ bool ensureDirectory(const juce::File& directory, juce::String& error)
     return true;
 }
 
-bool readAudioFile(const juce::File& file, AudioData& out, juce::String& error)
+juce::AudioFormatManager& getAudioFormatManager()
+{
+    // Registered once; after that it is only queried, from any thread.
+    static juce::AudioFormatManager formatManager;
+    static const bool registered = (formatManager.registerBasicFormats(), true);
+    juce::ignoreUnused(registered);
+
+    return formatManager;
+}
+
+std::unique_ptr<juce::AudioFormatReader> createAudioReader(const juce::File& file, juce::String& error)
 {
     if (!file.existsAsFile())
     {
         error = "File not found: " + file.getFullPathName();
-        return false;
+        return nullptr;
+    }
+
+    std::unique_ptr<juce::AudioFormatReader> reader;
+
+    // WAV and AIFF are memory-mapped, so samples are paged in from the page
+    // cache as they are read instead of being copied through a file stream.
+    // Mapping only reserves address space; it fails for files too large for
+    // it, which then fall back to streaming like every other format.
+    if (auto* format = getAudioFormatManager().findFormatForFileExtension(file.getFileExtension()))
+    {
+        std::unique_ptr<juce::MemoryMappedAudioFormatReader> mappedReader(format->createMemoryMappedReader(file));
+        if (mappedReader != nullptr && mappedReader->mapEntireFile())
+            reader = std::move(mappedReader);
     }
 
-    juce::AudioFormatManager formatManager;
-    formatManager.registerBasicFormats();
+    if (!reader)
+        reader = std::unique_ptr<juce::AudioFormatReader>(getAudioFormatManager().createReaderFor(file));
 
-    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(file));
     if (!reader)
     {
         error = "Unsupported or unreadable audio file: " + file.getFullPathName();
-        return false;
+        return nullptr;
     }
 
-    if (reader->lengthInSamples <= 0 || reader->lengthInSamples > std::numeric_limits<int>::max())
+    if (reader->lengthInSamples <= 0)
     {
-        error = "Invalid or too-large audio file: " + file.getFullPathName();
-        return false;
+        error = "Audio file is empty: " + file.getFullPathName();
+        return nullptr;
     }
 
-    const int numChannels = static_cast<int>(reader->numChannels);
-    const int numSamples = static_cast<int>(reader->lengthInSamples);
-
-    if (numChannels <= 0)
+    if (reader->numChannels <= 0)
     {
         error = "Audio file has no channels: " + file.getFullPathName();
+        return nullptr;
+    }
+
+    return reader;
+}
+
+// Input readers shared by the worker threads of run-suite and sweep. A
+// memory-mapped reader only copies out of its mapping, so it can serve every
+// worker at once: each input file is mapped once and repeated renders of it
+// cost no extra memory. Streaming readers keep a file position, so those are
+// still opened once per render.
+struct SharedInputReaders
+{
+    std::mutex mutex;
+    std::map<juce::String, std::shared_ptr<juce::AudioFormatReader>> mapped;
+};
+
+std::shared_ptr<juce::AudioFormatReader> getInputReader(SharedInputReaders& readers, const juce::File& file, juce::String& error)
+{
+    const std::lock_guard<std::mutex> lock(readers.mutex);
+
+    const auto key = file.getFullPathName();
+    if (const auto found = readers.mapped.find(key); found != readers.mapped.end())
+        return found->second;
+
+    std::shared_ptr<juce::AudioFormatReader> reader = createAudioReader(file, error);
+    if (dynamic_cast<juce::MemoryMappedAudioFormatReader*>(reader.get()) != nullptr)
+        readers.mapped.emplace(key, reader);
+
+    return reader;
+}
+
+bool readAudioFile(const juce::File& file, AudioData& out, juce::String& error)
+{
+    auto reader = createAudioReader(file, error);
+    if (!reader)
+        return false;
+
+    if (reader->lengthInSamples > std::numeric_limits<int>::max())
+    {
+        error = "Audio file too large to load into memory: " + file.getFullPathName();
         return false;
     }
 
+    const int numChannels = static_cast<int>(reader->numChannels);
+    const int numSamples = static_cast<int>(reader->lengthInSamples);
+
     out.buffer.setSize(numChannels, numSamples);
     out.buffer.clear();
 
-    std::vector<float*> writePointers(static_cast<size_t>(numChannels));
-    for (int channel = 0; channel < numChannels; ++channel)
-        writePointers[static_cast<size_t>(channel)] = out.buffer.getWritePointer(channel);
-
-    if (!reader->read(writePointers.data(), numChannels, 0, numSamples))
+    if (!reader->read(out.buffer.getArrayOfWritePointers(), numChannels, 0, numSamples))
     {
         error = "Failed to read audio samples from: " + file.getFullPathName();
         return false;
@@ -243,106 +610,345 @@ bool readAudioFile(const juce::File& file, AudioData& out, juce::String& error)
     return true;
 }
 
-bool writeWavFile(const juce::File& file,
-                  const juce::AudioBuffer<float>& buffer,
-                  double sampleRate,
-                  juce::String& error)
+std::unique_ptr<juce::OutputStream> createReplacedOutputStream(const juce::File& file, juce::String& error)
 {
-    juce::WavAudioFormat wavFormat;
+    // createOutputStream() appends to an existing file, which would leave the
+    // old contents after the new data.
+    if (file.existsAsFile() && !file.deleteFile())
+    {
+        error = "Failed to replace existing file: " + file.getFullPathName();
+        return nullptr;
+    }
+
     std::unique_ptr<juce::OutputStream> stream(file.createOutputStream());
 
     if (!stream)
-    {
         error = "Failed to open output file for writing: " + file.getFullPathName();
-        return false;
-    }
+
+    return stream;
+}
+
+std::unique_ptr<juce::AudioFormatWriter> createWavWriter(const juce::File& file,
+                                                         double sampleRate,
+                                                         int numChannels,
+                                                         juce::String& error,
+                                                         int bitsPerSample = 24)
+{
+    juce::WavAudioFormat wavFormat;
+
+    auto stream = createReplacedOutputStream(file, error);
+    if (!stream)
+        return nullptr;
 
     const auto writerOptions = juce::AudioFormatWriterOptions()
         .withSampleRate(sampleRate)
-        .withNumChannels(buffer.getNumChannels())
-        .withBitsPerSample(24);
+        .withNumChannels(numChannels)
+        .withBitsPerSample(bitsPerSample);
 
     auto writer = wavFormat.createWriterFor(stream, writerOptions);
 
     if (!writer)
-    {
         error = "Failed to create WAV writer for: " + file.getFullPathName();
-        return false;
-    }
 
-    if (!writer->writeFromAudioSampleBuffer(buffer, 0, buffer.getNumSamples()))
-    {
-        error = "Failed while writing WAV data: " + file.getFullPathName();
+    return writer;
+}
+
+enum class OutputFormat
+{
+    pcm16,
+    pcm24,
+    float32,
+    raw
+};
+
+bool parseOutputFormat(const juce::String& text, OutputFormat& format)
+{
+    if (text == "16")
+        format = OutputFormat::pcm16;
+    else if (text == "24")
+        format = OutputFormat::pcm24;
+    else if (text == "32f")
+        format = OutputFormat::float32;
+    else if (text == "raw")
+        format = OutputFormat::raw;
+    else
         return false;
-    }
 
     return true;
 }
 
-bool parseNumericVar(const juce::var& value, double& outValue)
+juce::String getOutputFileExtension(OutputFormat format)
 {
-    if (value.isInt() || value.isInt64() || value.isDouble() || value.isBool())
-    {
-        outValue = static_cast<double>(value);
-        return std::isfinite(outValue);
-    }
-
-    return false;
+    return format == OutputFormat::raw ? ".raw" : ".wav";
 }
 
-bool parseNormalizedValue(const juce::var& value,
-                          const juce::String& context,
-                          float& outValue,
-                          juce::String& error)
+// Interleaves numSamples frames of channels into little-endian float32, the
+// layout of raw output files.
+void interleaveFloat32(const float* const* source, int channels, int numSamples, float* destination)
 {
-    double normalized = 0.0;
-    if (!parseNumericVar(value, normalized))
-    {
-        error = context + " must be numeric";
-        return false;
-    }
+    using SourceFormat = juce::AudioData::Format<juce::AudioData::Float32, juce::AudioData::NativeEndian>;
+    using DestFormat = juce::AudioData::Format<juce::AudioData::Float32, juce::AudioData::LittleEndian>;
 
-    if (normalized < 0.0 || normalized > 1.0)
-    {
-        error = context + " must be within [0, 1]";
-        return false;
-    }
+    juce::AudioData::interleaveSamples(juce::AudioData::NonInterleavedSource<SourceFormat> { source, channels },
+                                       juce::AudioData::InterleavedDest<DestFormat> { destination, channels },
+                                       numSamples);
+}
 
-    outValue = static_cast<float>(normalized);
-    return true;
+// The inverse of interleaveFloat32.
+void deinterleaveFloat32(const float* source, int channels, int numSamples, float* const* destination)
+{
+    using SourceFormat = juce::AudioData::Format<juce::AudioData::Float32, juce::AudioData::LittleEndian>;
+    using DestFormat = juce::AudioData::Format<juce::AudioData::Float32, juce::AudioData::NativeEndian>;
+
+    juce::AudioData::deinterleaveSamples(juce::AudioData::InterleavedSource<SourceFormat> { source, channels },
+                                         juce::AudioData::NonInterleavedDest<DestFormat> { destination, channels },
+                                         numSamples);
 }
 
-bool parseParamsByNameObject(const juce::var& value,
-                             std::map<std::string, float>& outParamsByName,
-                             juce::String& error)
+// Writes rendered blocks to disk on a background thread, so sample
+// conversion and file I/O overlap with processing instead of stalling it.
+//
+// The render thread copies each block into a ring of preallocated slots
+// (single producer, single consumer, through juce::AbstractFifo) and only
+// waits when every slot is still queued. The ring holds about a second of
+// audio, which absorbs the occasional slow write.
+class BackgroundWriter
 {
-    auto* paramsObject = value.getDynamicObject();
-    if (paramsObject == nullptr)
+public:
+    BackgroundWriter(std::unique_ptr<juce::AudioFormatWriter> wavWriterToUse,
+                     std::unique_ptr<juce::OutputStream> rawStreamToUse,
+                     int numChannels,
+                     int maxBlockSize,
+                     double sampleRate)
+        : wavWriter(std::move(wavWriterToUse)),
+          rawStream(std::move(rawStreamToUse)),
+          channels(numChannels),
+          fifo(std::max(4, static_cast<int>(std::ceil(sampleRate / maxBlockSize))) + 1)
     {
-        error = "paramsByName must be a JSON object of name -> normalized value";
-        return false;
+        slots.resize(static_cast<size_t>(fifo.getTotalSize()));
+        for (auto& slot : slots)
+            slot.buffer.setSize(channels, maxBlockSize);
+
+        if (rawStream != nullptr)
+            interleaved.resize(static_cast<size_t>(channels) * static_cast<size_t>(maxBlockSize));
+
+        thread = std::thread([this] { run(); });
     }
 
-    const auto& properties = paramsObject->getProperties();
-    for (int i = 0; i < properties.size(); ++i)
+    ~BackgroundWriter()
     {
-        const juce::String parameterName = properties.getName(i).toString();
-        const juce::var parameterValue = properties.getValueAt(i);
+        juce::String ignored;
+        finish(ignored);
+    }
 
-        float normalized = 0.0f;
-        if (!parseNormalizedValue(parameterValue,
-                                  "Parameter value for '" + parameterName + "'",
-                                  normalized,
-                                  error))
-        {
+    // Render thread only. Returns false once a write has failed.
+    bool write(const float* const* data, int numSamples)
+    {
+        while (fifo.getFreeSpace() == 0 && !failed.load())
+            spaceFreed.wait();
+
+        if (failed.load())
             return false;
+
+        {
+            const auto scope = fifo.write(1);
+            auto& slot = slots[static_cast<size_t>(scope.startIndex1)];
+            for (int channel = 0; channel < channels; ++channel)
+                slot.buffer.copyFrom(channel, 0, data[channel], numSamples);
+            slot.numSamples = numSamples;
         }
 
-        outParamsByName[parameterName.toLowerCase().toStdString()] = normalized;
+        dataQueued.signal();
+        return true;
     }
 
-    return true;
-}
+    // Drains the ring, stops the thread and closes the file.
+    bool finish(juce::String& error)
+    {
+        if (thread.joinable())
+        {
+            finishing.store(true);
+            dataQueued.signal();
+            thread.join();
+
+            wavWriter.reset();
+            if (rawStream != nullptr)
+                rawStream->flush();
+            rawStream.reset();
+        }
+
+        if (failed.load())
+            error = "Failed while writing output data";
+
+        return !failed.load();
+    }
+
+private:
+    struct Slot
+    {
+        juce::AudioBuffer<float> buffer;
+        int numSamples = 0;
+    };
+
+    void run()
+    {
+        for (;;)
+        {
+            // Read before checking for data, so that every block queued
+            // before finish() is seen.
+            const bool lastPass = finishing.load();
+
+            if (fifo.getNumReady() == 0)
+            {
+                if (lastPass)
+                    return;
+
+                dataQueued.wait();
+                continue;
+            }
+
+            {
+                const auto scope = fifo.read(1);
+                const auto& slot = slots[static_cast<size_t>(scope.startIndex1)];
+
+                if (!failed.load() && !writeSlot(slot))
+                    failed.store(true);
+            }
+
+            spaceFreed.signal();
+        }
+    }
+
+    bool writeSlot(const Slot& slot)
+    {
+        if (wavWriter != nullptr)
+            return wavWriter->writeFromFloatArrays(slot.buffer.getArrayOfReadPointers(), channels, slot.numSamples);
+
+        interleaveFloat32(slot.buffer.getArrayOfReadPointers(), channels, slot.numSamples, interleaved.data());
+        return rawStream->write(interleaved.data(), sizeof(float) * static_cast<size_t>(channels) * static_cast<size_t>(slot.numSamples));
+    }
+
+    std::unique_ptr<juce::AudioFormatWriter> wavWriter;
+    std::unique_ptr<juce::OutputStream> rawStream;
+    const int channels;
+
+    juce::AbstractFifo fifo;
+    std::vector<Slot> slots;
+    std::vector<float> interleaved;
+
+    juce::WaitableEvent dataQueued;
+    juce::WaitableEvent spaceFreed;
+    std::atomic<bool> finishing { false };
+    std::atomic<bool> failed { false };
+    std::thread thread;
+};
+
+std::unique_ptr<BackgroundWriter> createBackgroundWriter(const juce::File& file,
+                                                         OutputFormat format,
+                                                         double sampleRate,
+                                                         int numChannels,
+                                                         int maxBlockSize,
+                                                         juce::String& error)
+{
+    std::unique_ptr<juce::AudioFormatWriter> wavWriter;
+    std::unique_ptr<juce::OutputStream> rawStream;
+
+    if (format == OutputFormat::raw)
+    {
+        rawStream = createReplacedOutputStream(file, error);
+        if (rawStream == nullptr)
+            return nullptr;
+    }
+    else
+    {
+        const int bitsPerSample = format == OutputFormat::pcm16 ? 16 : (format == OutputFormat::pcm24 ? 24 : 32);
+        wavWriter = createWavWriter(file, sampleRate, numChannels, error, bitsPerSample);
+        if (wavWriter == nullptr)
+            return nullptr;
+    }
+
+    return std::make_unique<BackgroundWriter>(std::move(wavWriter), std::move(rawStream), numChannels, maxBlockSize, sampleRate);
+}
+
+bool writeJsonFile(const juce::File& file, const juce::var& value, juce::String& error)
+{
+    const auto json = juce::JSON::toString(
+        value,
+        juce::JSON::FormatOptions().withSpacing(juce::JSON::Spacing::multiLine).withEncoding(juce::JSON::Encoding::ascii));
+
+    if (!file.replaceWithText(json))
+    {
+        error = "Failed to write JSON: " + file.getFullPathName();
+        return false;
+    }
+
+    return true;
+}
+
+bool parseNumericVar(const juce::var& value, double& outValue)
+{
+    if (value.isInt() || value.isInt64() || value.isDouble() || value.isBool())
+    {
+        outValue = static_cast<double>(value);
+        return std::isfinite(outValue);
+    }
+
+    return false;
+}
+
+bool parseNormalizedValue(const juce::var& value,
+                          const juce::String& context,
+                          float& outValue,
+                          juce::String& error)
+{
+    double normalized = 0.0;
+    if (!parseNumericVar(value, normalized))
+    {
+        error = context + " must be numeric";
+        return false;
+    }
+
+    if (normalized < 0.0 || normalized > 1.0)
+    {
+        error = context + " must be within [0, 1]";
+        return false;
+    }
+
+    outValue = static_cast<float>(normalized);
+    return true;
+}
+
+bool parseParamsByNameObject(const juce::var& value,
+                             std::map<std::string, float>& outParamsByName,
+                             juce::String& error)
+{
+    auto* paramsObject = value.getDynamicObject();
+    if (paramsObject == nullptr)
+    {
+        error = "paramsByName must be a JSON object of name -> normalized value";
+        return false;
+    }
+
+    const auto& properties = paramsObject->getProperties();
+    for (int i = 0; i < properties.size(); ++i)
+    {
+        const juce::String parameterName = properties.getName(i).toString();
+        const juce::var parameterValue = properties.getValueAt(i);
+
+        float normalized = 0.0f;
+        if (!parseNormalizedValue(parameterValue,
+                                  "Parameter value for '" + parameterName + "'",
+                                  normalized,
+                                  error))
+        {
+            return false;
+        }
+
+        outParamsByName[parameterName.toLowerCase().toStdString()] = normalized;
+    }
+
+    return true;
+}
 
 bool parseParamsByIndexObject(const juce::var& value,
                               std::map<int, float>& outParamsByIndex,
@@ -383,6 +989,223 @@ bool parseParamsByIndexObject(const juce::var& value,
     return true;
 }
 
+bool parseAutomationPoint(const juce::var& value,
+                          const juce::String& context,
+                          AutomationPoint& outPoint,
+                          juce::String& error)
+{
+    juce::var timeValue;
+    juce::var normalizedValue;
+
+    if (const auto* pair = value.getArray(); pair != nullptr && pair->size() == 2)
+    {
+        timeValue = pair->getReference(0);
+        normalizedValue = pair->getReference(1);
+    }
+    else if (auto* pointObject = value.getDynamicObject(); pointObject != nullptr)
+    {
+        timeValue = pointObject->getProperty("time");
+        normalizedValue = pointObject->getProperty("value");
+    }
+    else
+    {
+        error = context + " must be [seconds, value] or {\"time\": seconds, \"value\": value}";
+        return false;
+    }
+
+    if (!parseNumericVar(timeValue, outPoint.seconds) || outPoint.seconds < 0.0)
+    {
+        error = context + " time must be a non-negative number of seconds";
+        return false;
+    }
+
+    return parseNormalizedValue(normalizedValue, context + " value", outPoint.value, error);
+}
+
+// Reads the "name" or "index" property (exactly one is required) that
+// automation lanes and sweep axes use to refer to a plugin parameter.
+bool parseParameterReference(const juce::DynamicObject& object,
+                             const juce::String& context,
+                             std::optional<std::string>& outNameLowercase,
+                             std::optional<int>& outIndex,
+                             juce::String& error)
+{
+    if (object.hasProperty("name") == object.hasProperty("index"))
+    {
+        error = context + " must have exactly one of \"name\" or \"index\"";
+        return false;
+    }
+
+    if (object.hasProperty("name"))
+    {
+        outNameLowercase = object.getProperty("name").toString().toLowerCase().toStdString();
+        return true;
+    }
+
+    double index = 0.0;
+    if (!parseNumericVar(object.getProperty("index"), index)
+        || index < 0.0
+        || index != std::floor(index)
+        || index > static_cast<double>(std::numeric_limits<int>::max()))
+    {
+        error = context + " index must be a non-negative integer";
+        return false;
+    }
+
+    outIndex = static_cast<int>(index);
+    return true;
+}
+
+bool parseAutomationLanes(const juce::var& value,
+                          std::vector<AutomationLaneSpec>& outLanes,
+                          juce::String& error)
+{
+    const auto* lanes = value.getArray();
+    if (lanes == nullptr)
+    {
+        error = "automation must be a JSON array of lanes";
+        return false;
+    }
+
+    for (int laneIndex = 0; laneIndex < lanes->size(); ++laneIndex)
+    {
+        const juce::String context = "automation[" + juce::String(laneIndex) + "]";
+        auto* laneObject = lanes->getReference(laneIndex).getDynamicObject();
+        if (laneObject == nullptr)
+        {
+            error = context + " must be a JSON object";
+            return false;
+        }
+
+        AutomationLaneSpec lane;
+        if (!parseParameterReference(*laneObject, context, lane.nameLowercase, lane.index, error))
+            return false;
+
+        const auto curveName = laneObject->hasProperty("curve") ? laneObject->getProperty("curve").toString() : juce::String("linear");
+        if (curveName == "linear")
+            lane.curve = AutomationCurve::linear;
+        else if (curveName == "step")
+            lane.curve = AutomationCurve::step;
+        else
+        {
+            error = context + " curve must be \"linear\" or \"step\", got '" + curveName + "'";
+            return false;
+        }
+
+        const auto* points = laneObject->getProperty("points").getArray();
+        if (points == nullptr || points->isEmpty())
+        {
+            error = context + " points must be a non-empty array";
+            return false;
+        }
+
+        for (int pointIndex = 0; pointIndex < points->size(); ++pointIndex)
+        {
+            AutomationPoint point;
+            if (!parseAutomationPoint(points->getReference(pointIndex),
+                                      context + ".points[" + juce::String(pointIndex) + "]",
+                                      point,
+                                      error))
+            {
+                return false;
+            }
+            lane.points.push_back(point);
+        }
+
+        std::stable_sort(lane.points.begin(), lane.points.end(), [](const auto& a, const auto& b)
+        {
+            return a.seconds < b.seconds;
+        });
+
+        outLanes.push_back(std::move(lane));
+    }
+
+    return true;
+}
+
+// "sweep": [ { "name": "Drive", "values": [0, 0.5, 1] },
+//            { "index": 3, "from": 0, "to": 1, "steps": 11 } ]
+bool parseSweepAxes(const juce::var& value,
+                    std::vector<SweepAxisSpec>& outAxes,
+                    juce::String& error)
+{
+    const auto* axes = value.getArray();
+    if (axes == nullptr)
+    {
+        error = "sweep must be a JSON array of axes";
+        return false;
+    }
+
+    for (int axisIndex = 0; axisIndex < axes->size(); ++axisIndex)
+    {
+        const juce::String context = "sweep[" + juce::String(axisIndex) + "]";
+        auto* axisObject = axes->getReference(axisIndex).getDynamicObject();
+        if (axisObject == nullptr)
+        {
+            error = context + " must be a JSON object";
+            return false;
+        }
+
+        SweepAxisSpec axis;
+        if (!parseParameterReference(*axisObject, context, axis.nameLowercase, axis.index, error))
+            return false;
+
+        const bool hasValues = axisObject->hasProperty("values");
+        const bool hasRange = axisObject->hasProperty("from") || axisObject->hasProperty("to") || axisObject->hasProperty("steps");
+        if (hasValues == hasRange)
+        {
+            error = context + " must have either \"values\" or \"from\"/\"to\"/\"steps\"";
+            return false;
+        }
+
+        if (hasValues)
+        {
+            const auto* values = axisObject->getProperty("values").getArray();
+            if (values == nullptr || values->isEmpty())
+            {
+                error = context + " values must be a non-empty array";
+                return false;
+            }
+
+            for (int i = 0; i < values->size(); ++i)
+            {
+                float normalized = 0.0f;
+                if (!parseNormalizedValue(values->getReference(i), context + ".values[" + juce::String(i) + "]", normalized, error))
+                    return false;
+                axis.values.push_back(normalized);
+            }
+        }
+        else
+        {
+            float from = 0.0f;
+            float to = 0.0f;
+            double steps = 0.0;
+            if (!parseNormalizedValue(axisObject->getProperty("from"), context + " from", from, error)
+                || !parseNormalizedValue(axisObject->getProperty("to"), context + " to", to, error))
+            {
+                return false;
+            }
+
+            if (!parseNumericVar(axisObject->getProperty("steps"), steps) || steps < 1.0 || steps != std::floor(steps) || steps > 100000.0)
+            {
+                error = context + " steps must be a positive integer";
+                return false;
+            }
+
+            const int numSteps = static_cast<int>(steps);
+            for (int i = 0; i < numSteps; ++i)
+            {
+                const double proportion = numSteps > 1 ? static_cast<double>(i) / static_cast<double>(numSteps - 1) : 0.0;
+                axis.values.push_back(static_cast<float>(from + (to - from) * proportion));
+            }
+        }
+
+        outAxes.push_back(std::move(axis));
+    }
+
+    return true;
+}
+
 bool parseRenderCaseFile(const juce::File& caseFile, RenderCase& renderCase, juce::String& error)
 {
     if (!caseFile.existsAsFile())
@@ -406,6 +1229,50 @@ bool parseRenderCaseFile(const juce::File& caseFile, RenderCase& renderCase, juc
         return false;
     }
 
+    const std::pair<const char*, std::optional<juce::String>*> pathFields[] = {
+        { "plugin", &renderCase.plugin },
+        { "input", &renderCase.input },
+    };
+
+    for (const auto& [key, field] : pathFields)
+    {
+        if (!rootObject->hasProperty(key))
+            continue;
+
+        const auto value = rootObject->getProperty(key);
+        if (!value.isString() || value.toString().isEmpty())
+        {
+            error = juce::String(key) + " must be a non-empty string";
+            return false;
+        }
+
+        *field = value.toString();
+    }
+
+    const std::pair<const char*, std::optional<int>*> positiveIntegerFields[] = {
+        { "sampleRate", &renderCase.sampleRate },
+        { "blockSize", &renderCase.blockSize },
+        { "channels", &renderCase.channels },
+    };
+
+    for (const auto& [key, field] : positiveIntegerFields)
+    {
+        if (!rootObject->hasProperty(key))
+            continue;
+
+        double value = 0.0;
+        if (!parseNumericVar(rootObject->getProperty(key), value)
+            || value <= 0.0
+            || value != std::floor(value)
+            || value > static_cast<double>(std::numeric_limits<int>::max()))
+        {
+            error = juce::String(key) + " must be a positive integer";
+            return false;
+        }
+
+        *field = static_cast<int>(value);
+    }
+
     if (rootObject->hasProperty("warmupMs"))
     {
         double warmup = 0.0;
@@ -447,6 +1314,32 @@ bool parseRenderCaseFile(const juce::File& caseFile, RenderCase& renderCase, juc
         return false;
     }
 
+    if (rootObject->hasProperty("automation")
+        && !parseAutomationLanes(rootObject->getProperty("automation"), renderCase.automation, error))
+    {
+        return false;
+    }
+
+    if (rootObject->hasProperty("automationIntervalSamples"))
+    {
+        double interval = 0.0;
+        if (!parseNumericVar(rootObject->getProperty("automationIntervalSamples"), interval)
+            || interval < 1.0
+            || interval != std::floor(interval)
+            || interval > static_cast<double>(std::numeric_limits<int>::max()))
+        {
+            error = "automationIntervalSamples must be a positive integer";
+            return false;
+        }
+        renderCase.automationIntervalSamples = static_cast<int>(interval);
+    }
+
+    if (rootObject->hasProperty("sweep")
+        && !parseSweepAxes(rootObject->getProperty("sweep"), renderCase.sweep, error))
+    {
+        return false;
+    }
+
     return true;
 }
 
@@ -495,41 +1388,223 @@ bool loadVst3Description(juce::AudioPluginFormatManager& manager,
     return false;
 }
 
-std::unique_ptr<juce::AudioPluginInstance> createVst3Instance(const juce::File& pluginPath,
-                                                              double sampleRate,
-                                                              int blockSize,
-                                                              juce::String& error)
+PluginCacheOptions getPluginCacheOptions(const OptionMap& options)
+{
+    PluginCacheOptions cacheOptions;
+    cacheOptions.enabled = !getFlag(options, "no-cache");
+
+    juce::String cachePathText;
+    if (getOptionalOption(options, "plugin-cache", cachePathText))
+        cacheOptions.file = resolvePath(cachePathText);
+    else
+        cacheOptions.file = juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+                                .getChildFile("vst3_harness")
+                                .getChildFile("plugin_cache.xml");
+
+    return cacheOptions;
+}
+
+// Identifies the on-disk state of a plugin without loading it: the newest
+// modification time and the total size of every file in the bundle.
+PluginFingerprint fingerprintPlugin(const juce::File& pluginPath)
+{
+    PluginFingerprint fingerprint;
+    fingerprint.path = pluginPath.getFullPathName();
+
+    juce::Array<juce::File> files;
+    if (pluginPath.isDirectory())
+        pluginPath.findChildFiles(files, juce::File::findFiles, true);
+    else
+        files.add(pluginPath);
+
+    for (const auto& file : files)
+    {
+        fingerprint.modificationTime = std::max(fingerprint.modificationTime, file.getLastModificationTime().toMilliseconds());
+        fingerprint.totalBytes += file.getSize();
+    }
+
+    return fingerprint;
+}
+
+// The cache file is a regular KnownPluginList XML document. Each cached plugin
+// additionally gets a CACHEKEY element recording the fingerprint it was scanned
+// at; KnownPluginList ignores elements it does not recognise.
+constexpr const char* cacheKeyTag = "CACHEKEY";
+
+bool findCachedDescription(const juce::File& cacheFile,
+                           const PluginFingerprint& fingerprint,
+                           juce::PluginDescription& outDescription)
+{
+    if (!cacheFile.existsAsFile())
+        return false;
+
+    const auto xml = juce::parseXML(cacheFile);
+    if (xml == nullptr)
+        return false;
+
+    for (const auto* key : xml->getChildWithTagNameIterator(cacheKeyTag))
+    {
+        if (key->getStringAttribute("path") != fingerprint.path
+            || key->getStringAttribute("modTime").getLargeIntValue() != fingerprint.modificationTime
+            || key->getStringAttribute("size").getLargeIntValue() != fingerprint.totalBytes)
+        {
+            continue;
+        }
+
+        juce::KnownPluginList knownPlugins;
+        knownPlugins.recreateFromXml(*xml);
+
+        const auto identifier = key->getStringAttribute("identifier");
+        for (const auto& type : knownPlugins.getTypes())
+        {
+            if (type.matchesIdentifierString(identifier))
+            {
+                outDescription = type;
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+void storeCachedDescription(const juce::File& cacheFile,
+                            const PluginFingerprint& fingerprint,
+                            const juce::PluginDescription& description)
+{
+    juce::KnownPluginList knownPlugins;
+    juce::OwnedArray<juce::XmlElement> otherKeys;
+
+    if (auto existing = cacheFile.existsAsFile() ? juce::parseXML(cacheFile) : nullptr)
+    {
+        knownPlugins.recreateFromXml(*existing);
+
+        for (const auto* key : existing->getChildWithTagNameIterator(cacheKeyTag))
+        {
+            if (key->getStringAttribute("path") != fingerprint.path)
+                otherKeys.add(new juce::XmlElement(*key));
+        }
+    }
+
+    knownPlugins.removeType(description);
+    knownPlugins.addType(description);
+
+    auto xml = knownPlugins.createXml();
+    if (xml == nullptr)
+        return;
+
+    for (auto* key : otherKeys)
+        xml->addChildElement(new juce::XmlElement(*key));
+
+    auto* key = xml->createNewChildElement(cacheKeyTag);
+    key->setAttribute("path", fingerprint.path);
+    key->setAttribute("modTime", juce::String(fingerprint.modificationTime));
+    key->setAttribute("size", juce::String(fingerprint.totalBytes));
+    key->setAttribute("identifier", description.createIdentifierString());
+
+    // Write to a temporary file and swap it in so concurrent harness runs
+    // never observe a half-written cache.
+    if (cacheFile.getParentDirectory().createDirectory().failed())
+        return;
+
+    juce::TemporaryFile temporary(cacheFile);
+    if (xml->writeTo(temporary.getFile()))
+        temporary.overwriteTargetFileWithTemporary();
+}
+
+bool loadVst3DescriptionCached(juce::AudioPluginFormatManager& manager,
+                               const juce::File& pluginPath,
+                               const PluginCacheOptions& cacheOptions,
+                               juce::PluginDescription& outDescription,
+                               juce::String& error)
+{
+    const auto start = std::chrono::steady_clock::now();
+    auto elapsedMs = [start]
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    if (!cacheOptions.enabled)
+    {
+        if (!loadVst3Description(manager, pluginPath, outDescription, error))
+            return false;
+
+        std::clog << "Plugin scan: " << elapsedMs() << " ms (cache disabled)\n";
+        return true;
+    }
+
+    if (!pluginPath.exists())
+    {
+        error = "Plugin path does not exist: " + pluginPath.getFullPathName();
+        return false;
+    }
+
+    const auto fingerprint = fingerprintPlugin(pluginPath);
+    if (findCachedDescription(cacheOptions.file, fingerprint, outDescription))
+    {
+        std::clog << "Plugin description cache hit: " << elapsedMs() << " ms\n";
+        return true;
+    }
+
+    if (!loadVst3Description(manager, pluginPath, outDescription, error))
+        return false;
+
+    const double scanMs = elapsedMs();
+    storeCachedDescription(cacheOptions.file, fingerprint, outDescription);
+    std::clog << "Plugin scan: " << scanMs << " ms (cache miss, stored in " << cacheOptions.file.getFullPathName() << ")\n";
+    return true;
+}
+
+// Loads the plugin description once and creates `count` independent
+// instances from it. Must be called on the message thread.
+std::vector<std::unique_ptr<juce::AudioPluginInstance>> createVst3InstancePool(const juce::File& pluginPath,
+                                                                               const PluginCacheOptions& cacheOptions,
+                                                                               int count,
+                                                                               double sampleRate,
+                                                                               int blockSize,
+                                                                               juce::String& error)
 {
     juce::AudioPluginFormatManager formatManager;
     formatManager.addFormat(std::make_unique<juce::VST3PluginFormat>());
 
     juce::PluginDescription description;
-    if (!loadVst3Description(formatManager, pluginPath, description, error))
-        return nullptr;
+    if (!loadVst3DescriptionCached(formatManager, pluginPath, cacheOptions, description, error))
+        return {};
+
+    std::vector<std::unique_ptr<juce::AudioPluginInstance>> pool;
+    for (int i = 0; i < count; ++i)
+    {
+        auto instance = formatManager.createPluginInstance(description, sampleRate, blockSize, error);
+        if (instance == nullptr)
+        {
+            if (error.isEmpty())
+                error = "Plugin instantiation failed with no additional error detail";
+            return {};
+        }
 
-    auto instance = formatManager.createPluginInstance(description, sampleRate, blockSize, error);
-    if (instance == nullptr && error.isEmpty())
-        error = "Plugin instantiation failed with no additional error detail";
+        pool.push_back(std::move(instance));
+    }
 
-    return instance;
+    return pool;
 }
 
-juce::AudioChannelSet makeChannelSet(int channels)
+std::unique_ptr<juce::AudioPluginInstance> createVst3Instance(const juce::File& pluginPath,
+                                                              const PluginCacheOptions& cacheOptions,
+                                                              double sampleRate,
+                                                              int blockSize,
+                                                              juce::String& error)
 {
-    if (channels <= 1)
-        return juce::AudioChannelSet::mono();
-    if (channels == 2)
-        return juce::AudioChannelSet::stereo();
-    return juce::AudioChannelSet::discreteChannels(channels);
+    auto pool = createVst3InstancePool(pluginPath, cacheOptions, 1, sampleRate, blockSize, error);
+    return pool.empty() ? nullptr : std::move(pool.front());
 }
 
 bool configurePluginForChannels(juce::AudioPluginInstance& instance,
-                                int channels,
+                                const juce::AudioChannelSet& channelLayout,
                                 double sampleRate,
                                 int blockSize,
                                 juce::String& error)
 {
-    if (channels <= 0)
+    if (channelLayout.size() <= 0)
     {
         error = "Channel count must be positive";
         return false;
@@ -538,12 +1613,15 @@ bool configurePluginForChannels(juce::AudioPluginInstance& instance,
     instance.enableAllBuses();
 
     juce::AudioProcessor::BusesLayout layout;
-    const auto requestedChannels = makeChannelSet(channels);
-    layout.inputBuses.add(requestedChannels);
-    layout.outputBuses.add(requestedChannels);
+    layout.inputBuses.add(channelLayout);
+    layout.outputBuses.add(channelLayout);
 
     if (!instance.setBusesLayout(layout))
+    {
         instance.disableNonMainBuses();
+        std::cerr << "Warning: plugin does not accept the " << channelLayout.getDescription()
+                  << " layout; using " << instance.getMainBusNumOutputChannels() << " output channels\n";
+    }
 
     instance.setRateAndBufferSizeDetails(sampleRate, blockSize);
 
@@ -556,36 +1634,31 @@ bool configurePluginForChannels(juce::AudioPluginInstance& instance,
     return true;
 }
 
+juce::AudioProcessorParameter* findParameterByName(juce::AudioPluginInstance& instance, const std::string& nameLowercase)
+{
+    for (auto* parameter : instance.getParameters())
+    {
+        if (parameter != nullptr && parameter->getName(256).toLowerCase().toStdString() == nameLowercase)
+            return parameter;
+    }
+
+    return nullptr;
+}
+
 bool applyParameterMapByName(juce::AudioPluginInstance& instance,
                              const std::map<std::string, float>& parameterValues,
                              juce::String& error)
 {
-    auto& parameters = instance.getParameters();
-
     for (const auto& [nameLowercase, normalizedValue] : parameterValues)
     {
-        bool found = false;
-
-        for (int i = 0; i < parameters.size(); ++i)
-        {
-            auto* parameter = parameters.getUnchecked(i);
-            if (parameter == nullptr)
-                continue;
-
-            const auto parameterName = parameter->getName(256).toLowerCase().toStdString();
-            if (parameterName == nameLowercase)
-            {
-                parameter->setValueNotifyingHost(normalizedValue);
-                found = true;
-                break;
-            }
-        }
-
-        if (!found)
+        auto* parameter = findParameterByName(instance, nameLowercase);
+        if (parameter == nullptr)
         {
             error = "Could not find plugin parameter named: " + juce::String(nameLowercase);
             return false;
         }
+
+        parameter->setValueNotifyingHost(normalizedValue);
     }
 
     return true;
@@ -619,345 +1692,2852 @@ bool applyParameterMapByIndex(juce::AudioPluginInstance& instance,
     return true;
 }
 
-juce::AudioBuffer<float> copyChannels(const juce::AudioBuffer<float>& source, int channels)
+bool buildAutomation(juce::AudioPluginInstance& instance,
+                     const RenderCase& renderCase,
+                     double sampleRate,
+                     Automation& outAutomation,
+                     juce::String& error)
 {
-    const int sourceChannels = source.getNumChannels();
-    const int sourceSamples = source.getNumSamples();
+    auto& parameters = instance.getParameters();
+    outAutomation.lanes.clear();
+    outAutomation.intervalSamples = renderCase.automationIntervalSamples;
+
+    for (const auto& spec : renderCase.automation)
+    {
+        AutomationLane lane;
+        lane.curve = spec.curve;
 
-    juce::AudioBuffer<float> result(channels, sourceSamples);
-    result.clear();
+        if (spec.nameLowercase.has_value())
+        {
+            lane.parameter = findParameterByName(instance, spec.nameLowercase.value());
+            if (lane.parameter == nullptr)
+            {
+                error = "Could not find automated plugin parameter named: " + juce::String(spec.nameLowercase.value());
+                return false;
+            }
+        }
+        else
+        {
+            const int index = spec.index.value_or(-1);
+            if (index < 0 || index >= parameters.size() || parameters.getUnchecked(index) == nullptr)
+            {
+                error = "Automated parameter index out of range: " + juce::String(index)
+                      + " (num parameters: " + juce::String(parameters.size()) + ")";
+                return false;
+            }
+            lane.parameter = parameters.getUnchecked(index);
+        }
 
-    if (sourceChannels <= 0)
-        return result;
+        for (const auto& point : spec.points)
+            lane.breakpoints.push_back({ static_cast<juce::int64>(std::llround(point.seconds * sampleRate)), point.value });
 
-    for (int channel = 0; channel < channels; ++channel)
-    {
-        const int sourceChannel = std::min(channel, sourceChannels - 1);
-        result.copyFrom(channel, 0, source, sourceChannel, 0, sourceSamples);
+        outAutomation.lanes.push_back(std::move(lane));
     }
 
-    return result;
+    return true;
 }
 
-bool containsNaNOrInf(const juce::AudioBuffer<float>& buffer)
+float automationValueAt(const AutomationLane& lane, juce::int64 position)
 {
-    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+    const auto& points = lane.breakpoints;
+    const auto next = std::upper_bound(points.begin(), points.end(), position, [](juce::int64 pos, const auto& point)
     {
-        const float* samples = buffer.getReadPointer(channel);
-        for (int i = 0; i < buffer.getNumSamples(); ++i)
+        return pos < point.position;
+    });
+
+    if (next == points.begin())
+        return points.front().value;
+    if (next == points.end())
+        return points.back().value;
+
+    const auto& previous = *std::prev(next);
+    if (lane.curve == AutomationCurve::step)
+        return previous.value;
+
+    const double proportion = static_cast<double>(position - previous.position)
+                            / static_cast<double>(next->position - previous.position);
+    return static_cast<float>(previous.value + proportion * static_cast<double>(next->value - previous.value));
+}
+
+void applyAutomationAt(Automation& automation, juce::int64 position)
+{
+    for (auto& lane : automation.lanes)
+    {
+        const float value = automationValueAt(lane, position);
+        if (value != lane.lastSentValue)
         {
-            if (!std::isfinite(samples[i]))
-                return true;
+            lane.parameter->setValueNotifyingHost(value);
+            lane.lastSentValue = value;
         }
     }
+}
 
-    return false;
+// Length of the sub-block starting at `position`: it ends at the next
+// breakpoint of any lane, and while a linear lane is ramping it is at most
+// intervalSamples long so the ramp is delivered in small steps.
+int nextAutomationSegmentLength(const Automation& automation, juce::int64 position, int maxSamples)
+{
+    juce::int64 end = position + maxSamples;
+
+    for (const auto& lane : automation.lanes)
+    {
+        const auto& points = lane.breakpoints;
+        const auto next = std::upper_bound(points.begin(), points.end(), position, [](juce::int64 pos, const auto& point)
+        {
+            return pos < point.position;
+        });
+
+        if (next == points.end())
+            continue;
+
+        end = std::min(end, next->position);
+
+        if (lane.curve == AutomationCurve::linear && next != points.begin() && std::prev(next)->value != next->value)
+            end = std::min(end, position + automation.intervalSamples);
+    }
+
+    return static_cast<int>(std::max<juce::int64>(1, end - position));
 }
 
-LevelMetrics computeLevels(const juce::AudioBuffer<float>& buffer)
+#if JUCE_LINUX
+constexpr const char* rtCheckShimEnvVar = "VST3_HARNESS_RTCHECK_SHIM";
+constexpr const char* rtCheckRelaunchedEnvVar = "VST3_HARNESS_RTCHECK_RELAUNCHED";
+
+juce::File getRtCheckShimFile()
 {
-    LevelMetrics metrics;
+    if (const char* overridePath = std::getenv(rtCheckShimEnvVar); overridePath != nullptr && *overridePath != 0)
+        return resolvePath(overridePath);
 
-    if (buffer.getNumChannels() <= 0 || buffer.getNumSamples() <= 0)
-        return metrics;
+    return juce::File::getSpecialLocation(juce::File::currentExecutableFile).getSiblingFile("libvst3_harness_rtcheck.so");
+}
 
-    double peak = 0.0;
-    double sumSquares = 0.0;
+bool isRtCheckShimLoaded()
+{
+    return dlsym(RTLD_DEFAULT, VST3_HARNESS_RTCHECK_BEGIN) != nullptr;
+}
 
-    for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+// The shim has to be interposed ahead of libc, which only LD_PRELOAD at process
+// start can do, so with --rt-check the harness re-executes itself with it set.
+// Returns only when that is not needed or not possible; createRtCheck then
+// reports what is missing.
+void relaunchWithRtCheckShimIfNeeded(int argc, char* argv[])
+{
+    const bool wantsRtCheck = std::any_of(argv + 1, argv + argc, [](const char* arg)
     {
-        const float* samples = buffer.getReadPointer(channel);
-        for (int i = 0; i < buffer.getNumSamples(); ++i)
-        {
-            const double value = static_cast<double>(samples[i]);
-            peak = std::max(peak, std::abs(value));
-            sumSquares += value * value;
-        }
-    }
+        return juce::String(arg) == "--rt-check";
+    });
 
-    const double count = static_cast<double>(buffer.getNumChannels()) * static_cast<double>(buffer.getNumSamples());
-    const double rms = count > 0.0 ? std::sqrt(sumSquares / count) : 0.0;
+    if (!wantsRtCheck || isRtCheckShimLoaded() || std::getenv(rtCheckRelaunchedEnvVar) != nullptr)
+        return;
 
-    metrics.peakDbfs = juce::Decibels::gainToDecibels(static_cast<float>(peak), -160.0f);
-    metrics.rmsDbfs = juce::Decibels::gainToDecibels(static_cast<float>(rms), -160.0f);
-    return metrics;
+    const juce::File shimFile = getRtCheckShimFile();
+    if (!shimFile.existsAsFile())
+        return;
+
+    juce::String preload = shimFile.getFullPathName();
+    if (const char* existing = std::getenv("LD_PRELOAD"); existing != nullptr && *existing != 0)
+        preload << ":" << existing;
+
+    setenv("LD_PRELOAD", preload.toRawUTF8(), 1);
+    setenv(rtCheckRelaunchedEnvVar, "1", 1);
+    execv("/proc/self/exe", argv);
 }
 
-std::vector<float> makeMonoSum(const juce::AudioBuffer<float>& buffer)
+juce::String describeRtCheckFrame(void* address)
 {
-    const int channels = buffer.getNumChannels();
-    const int numSamples = buffer.getNumSamples();
-    std::vector<float> mono(static_cast<size_t>(numSamples), 0.0f);
+    const auto addressValue = reinterpret_cast<juce::pointer_sized_uint>(address);
 
-    if (channels <= 0 || numSamples <= 0)
-        return mono;
+    Dl_info info {};
+    if (dladdr(address, &info) == 0 || info.dli_fname == nullptr)
+        return "0x" + juce::String::toHexString(static_cast<juce::int64>(addressValue));
 
-    const float scale = 1.0f / static_cast<float>(channels);
-    for (int channel = 0; channel < channels; ++channel)
+    const juce::String module = juce::File(info.dli_fname).getFileName();
+    if (info.dli_sname == nullptr || info.dli_saddr == nullptr)
     {
-        const float* samples = buffer.getReadPointer(channel);
-        for (int i = 0; i < numSamples; ++i)
-            mono[static_cast<size_t>(i)] += samples[i] * scale;
+        const auto offset = addressValue - reinterpret_cast<juce::pointer_sized_uint>(info.dli_fbase);
+        return module + " +0x" + juce::String::toHexString(static_cast<juce::int64>(offset));
     }
 
-    return mono;
+    int status = 0;
+    char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+    const juce::String symbol = (status == 0 && demangled != nullptr) ? juce::String(demangled) : juce::String(info.dli_sname);
+    std::free(demangled);
+
+    const auto offset = addressValue - reinterpret_cast<juce::pointer_sized_uint>(info.dli_saddr);
+    return module + " " + symbol + " +0x" + juce::String::toHexString(static_cast<juce::int64>(offset));
 }
+#endif
 
-int detectLatencyByCrossCorrelation(const std::vector<float>& dry,
-                                    const std::vector<float>& wet,
-                                    int maxLagSamples)
+bool createRtCheck(const OptionMap& options, RtCheck& rtCheck, juce::String& error)
 {
-    int bestLag = 0;
-    double bestScore = -1.0;
+    rtCheck = {};
+    if (!getFlag(options, "rt-check"))
+        return true;
 
-    const int drySize = static_cast<int>(dry.size());
-    const int wetSize = static_cast<int>(wet.size());
+   #if JUCE_LINUX
+    rtCheck.begin = reinterpret_cast<RtCheckBeginFn>(dlsym(RTLD_DEFAULT, VST3_HARNESS_RTCHECK_BEGIN));
+    rtCheck.end = reinterpret_cast<RtCheckEndFn>(dlsym(RTLD_DEFAULT, VST3_HARNESS_RTCHECK_END));
+    rtCheck.getSites = reinterpret_cast<RtCheckGetSitesFn>(dlsym(RTLD_DEFAULT, VST3_HARNESS_RTCHECK_GET_SITES));
 
-    for (int lag = -maxLagSamples; lag <= maxLagSamples; ++lag)
+    if (rtCheck.begin == nullptr || rtCheck.end == nullptr || rtCheck.getSites == nullptr)
     {
-        const int dryStart = lag < 0 ? -lag : 0;
-        const int wetStart = lag > 0 ? lag : 0;
-        const int overlap = std::min(drySize - dryStart, wetSize - wetStart);
+        rtCheck = {};
+        error = "--rt-check needs the realtime-safety shim, which is not loaded. Expected it at: "
+              + getRtCheckShimFile().getFullPathName() + " (set " + rtCheckShimEnvVar + " to override)";
+        return false;
+    }
 
-        if (overlap <= 0)
-            continue;
+    return true;
+   #else
+    error = "--rt-check is only supported on Linux";
+    return false;
+   #endif
+}
 
-        double dot = 0.0;
-        double dryEnergy = 0.0;
-        double wetEnergy = 0.0;
+// A lock that was the outermost one of every block it was taken in is the
+// plugin wrapper's callback lock (JUCE's wrappers hold it around the whole
+// processBlock, and nothing else on the audio thread contends with it). It is
+// listed in rt_check.json but not counted as a violation.
+bool isWrapperCallbackLock(const RtCheckSite& site)
+{
+    return site.kind == rtCheckMutexLock && site.outermostCount == site.count;
+}
 
-        for (int i = 0; i < overlap; ++i)
-        {
-            const double drySample = static_cast<double>(dry[static_cast<size_t>(dryStart + i)]);
-            const double wetSample = static_cast<double>(wet[static_cast<size_t>(wetStart + i)]);
-            dot += drySample * wetSample;
-            dryEnergy += drySample * drySample;
-            wetEnergy += wetSample * wetSample;
-        }
+juce::var makeRtCheckSiteObject(const RtCheckSite& site)
+{
+    juce::Array<juce::var> backtrace;
+    for (int frame = 0; frame < site.numFrames; ++frame)
+        backtrace.add(describeRtCheckFrame(site.frames[frame]));
+
+    juce::DynamicObject::Ptr siteObject = new juce::DynamicObject();
+    siteObject->setProperty("kind", juce::String(getRtCheckKindName(site.kind)));
+    siteObject->setProperty("count", static_cast<juce::int64>(site.count));
+    if (site.kind == rtCheckMutexLock)
+        siteObject->setProperty("contended", static_cast<juce::int64>(site.contendedCount));
+    siteObject->setProperty("firstBlock", static_cast<juce::int64>(site.firstBlock));
+    siteObject->setProperty("lastBlock", static_cast<juce::int64>(site.lastBlock));
+    siteObject->setProperty("backtrace", backtrace);
+    return juce::var(siteObject.get());
+}
 
-        if (dryEnergy <= 0.0 || wetEnergy <= 0.0)
-            continue;
+// Writes rt_check.json with one entry per distinct violation site, most frequent
+// first, prints a short summary to stderr and returns the total number of
+// violations through totalViolations.
+bool writeRtCheckReport(const RtCheck& rtCheck, const juce::File& outDir, juce::int64& totalViolations, juce::String& error)
+{
+    totalViolations = 0;
+    if (!rtCheck.isEnabled())
+        return true;
+
+   #if JUCE_LINUX
+    std::vector<RtCheckSite> recordedSites(static_cast<size_t>(rtCheckMaxSites));
+    std::int64_t total = 0;
+    std::int64_t dropped = 0;
+    const int numSites = rtCheck.getSites(recordedSites.data(), rtCheckMaxSites, &total, &dropped);
+    recordedSites.resize(static_cast<size_t>(std::max(0, numSites)));
 
-        const double correlation = dot / std::sqrt(dryEnergy * wetEnergy);
-        const double score = std::abs(correlation);
+    std::stable_sort(recordedSites.begin(), recordedSites.end(), [](const RtCheckSite& a, const RtCheckSite& b)
+    {
+        return a.count > b.count;
+    });
 
-        if (score > bestScore)
+    std::vector<RtCheckSite> sites;
+    juce::Array<juce::var> siteArray;
+    juce::Array<juce::var> callbackLockArray;
+    for (const auto& site : recordedSites)
+    {
+        if (isWrapperCallbackLock(site))
         {
-            bestScore = score;
-            bestLag = lag;
+            total -= site.count;
+            callbackLockArray.add(makeRtCheckSiteObject(site));
+        }
+        else
+        {
+            sites.push_back(site);
+            siteArray.add(makeRtCheckSiteObject(site));
         }
     }
 
-    return bestLag;
-}
+    juce::DynamicObject::Ptr reportObject = new juce::DynamicObject();
+    reportObject->setProperty("totalViolations", static_cast<juce::int64>(total));
+    reportObject->setProperty("distinctSites", static_cast<int>(sites.size()));
+    reportObject->setProperty("droppedSites", static_cast<juce::int64>(dropped));
+    reportObject->setProperty("sites", siteArray);
+    reportObject->setProperty("wrapperCallbackLocks", callbackLockArray);
 
-juce::AudioBuffer<float> shiftAndResize(const juce::AudioBuffer<float>& source,
-                                        int channels,
-                                        int targetSamples,
-                                        int shiftSamples)
-{
-    juce::AudioBuffer<float> result(channels, targetSamples);
-    result.clear();
+    if (!ensureDirectory(outDir, error))
+        return false;
 
-    for (int channel = 0; channel < channels; ++channel)
-    {
-        const int sourceChannel = std::min(channel, source.getNumChannels() - 1);
-        const float* sourceData = source.getReadPointer(sourceChannel);
-        float* destData = result.getWritePointer(channel);
-        const int sourceSamples = source.getNumSamples();
+    const juce::File reportPath = outDir.getChildFile("rt_check.json");
+    if (!writeJsonFile(reportPath, juce::var(reportObject.get()), error))
+        return false;
 
-        for (int i = 0; i < targetSamples; ++i)
+    totalViolations = static_cast<juce::int64>(total);
+
+    if (total == 0)
+    {
+        std::cerr << "rt-check: no allocations or locks inside processBlock\n";
+    }
+    else
+    {
+        std::cerr << "rt-check: " << total << " violations at " << sites.size() << " distinct sites inside processBlock\n";
+        for (size_t i = 0; i < std::min<size_t>(sites.size(), 5); ++i)
         {
-            const int sourceIndex = i - shiftSamples;
-            if (sourceIndex >= 0 && sourceIndex < sourceSamples)
-                destData[i] = sourceData[sourceIndex];
+            const auto& site = sites[i];
+            std::cerr << "  " << site.count << "x " << getRtCheckKindName(site.kind)
+                      << " (blocks " << site.firstBlock << "-" << site.lastBlock << ")";
+            if (site.numFrames > 0)
+                std::cerr << " at " << describeRtCheckFrame(site.frames[0]);
+            std::cerr << "\n";
         }
     }
 
-    return result;
+    std::cout << "Wrote: " << reportPath.getFullPathName() << "\n";
+    return true;
+   #else
+    juce::ignoreUnused(outDir);
+    error = "--rt-check is only supported on Linux";
+    return false;
+   #endif
 }
 
-double computeCorrelation(const juce::AudioBuffer<float>& a, const juce::AudioBuffer<float>& b)
+// The only place the harness calls processBlock outside of warm-up, so that
+// --rt-check covers exactly the measured/rendered blocks.
+template <typename SampleType>
+void processPluginBlock(juce::AudioPluginInstance& plugin,
+                        juce::AudioBuffer<SampleType>& buffer,
+                        juce::MidiBuffer& midi,
+                        const RtCheck& rtCheck,
+                        juce::int64 blockIndex)
 {
-    const auto monoA = makeMonoSum(a);
-    const auto monoB = makeMonoSum(b);
-
-    if (monoA.size() != monoB.size() || monoA.empty())
-        return 0.0;
-
-    double dot = 0.0;
-    double energyA = 0.0;
-    double energyB = 0.0;
+    if (rtCheck.isEnabled())
+        rtCheck.begin(blockIndex);
 
-    for (size_t i = 0; i < monoA.size(); ++i)
-    {
-        const double x = static_cast<double>(monoA[i]);
-        const double y = static_cast<double>(monoB[i]);
-        dot += x * y;
-        energyA += x * x;
-        energyB += y * y;
-    }
+    plugin.processBlock(buffer, midi);
 
-    if (energyA <= 0.0 || energyB <= 0.0)
-        return 0.0;
+    if (rtCheck.isEnabled())
+        rtCheck.end();
 
-    return dot / std::sqrt(energyA * energyB);
+    midi.clear();
 }
 
-int runDumpParams(const OptionMap& options)
+// Runs one host block through the plugin. With automation the block is split
+// at breakpoints (and every intervalSamples during linear ramps), with the
+// parameter values for each sub-block set before it is processed, which is how
+// a DAW delivers sample-positioned automation to a plugin that only sees
+// block-start parameter changes.
+template <typename SampleType>
+void processHostBlock(juce::AudioPluginInstance& plugin,
+                      juce::AudioBuffer<SampleType>& ioBlock,
+                      int numSamples,
+                      juce::int64 position,
+                      Automation& automation,
+                      juce::MidiBuffer& midi,
+                      const RtCheck& rtCheck)
 {
-    juce::String pluginPathText;
-    juce::String error;
-
-    if (!getRequiredOption(options, "plugin", pluginPathText, error))
-        return fail(error);
+    const juce::int64 blockIndex = position / std::max(1, ioBlock.getNumSamples());
 
-    const juce::File pluginPath = resolvePath(pluginPathText);
-    auto instance = createVst3Instance(pluginPath, 48000.0, 256, error);
-    if (instance == nullptr)
-        return fail(error);
+    if (automation.lanes.empty())
+    {
+        processPluginBlock(plugin, ioBlock, midi, rtCheck, blockIndex);
+        return;
+    }
 
-    auto& parameters = instance->getParameters();
-    for (int i = 0; i < parameters.size(); ++i)
+    for (int offset = 0; offset < numSamples;)
     {
-        auto* parameter = parameters.getUnchecked(i);
-        if (parameter == nullptr)
-            continue;
+        applyAutomationAt(automation, position + offset);
+        const int length = nextAutomationSegmentLength(automation, position + offset, numSamples - offset);
 
-        const auto name = parameter->getName(256);
-        const auto defaultNormalized = parameter->getDefaultValue();
-        std::cout << i << "\t" << name.toStdString() << "\t" << defaultNormalized << "\n";
+        juce::AudioBuffer<SampleType> segment(ioBlock.getArrayOfWritePointers(), ioBlock.getNumChannels(), offset, length);
+        processPluginBlock(plugin, segment, midi, rtCheck, blockIndex);
+
+        offset += length;
     }
+}
 
-    return 0;
+void resetParametersToDefaults(juce::AudioPluginInstance& instance)
+{
+    for (auto* parameter : instance.getParameters())
+    {
+        if (parameter != nullptr)
+            parameter->setValueNotifyingHost(parameter->getDefaultValue());
+    }
 }
 
-int runRender(const OptionMap& options)
+// Brings an existing instance into the state described by a case: bus layout,
+// rate and block size, default parameters overlaid with the case parameters,
+// and a reset. Instances reused across cases go through this between jobs.
+bool prepareInstanceForCase(juce::AudioPluginInstance& instance,
+                            const RenderCase& renderCase,
+                            double sampleRate,
+                            int blockSize,
+                            const juce::AudioChannelSet& channelLayout,
+                            juce::String& error)
 {
-    juce::String pluginPathText;
-    juce::String inputPathText;
-    juce::String outDirText;
+    if (!configurePluginForChannels(instance, channelLayout, sampleRate, blockSize, error))
+        return false;
+
+    instance.setRateAndBufferSizeDetails(sampleRate, blockSize);
+    instance.prepareToPlay(sampleRate, blockSize);
+
+    resetParametersToDefaults(instance);
+
+    if (!applyParameterMapByIndex(instance, renderCase.paramsByIndex, error))
+        return false;
+
+    if (!applyParameterMapByName(instance, renderCase.paramsByName, error))
+        return false;
+
+    instance.reset();
+    return true;
+}
+
+std::unique_ptr<juce::AudioPluginInstance> createPreparedPlugin(const juce::File& pluginPath,
+                                                                const PluginCacheOptions& cacheOptions,
+                                                                const RenderCase& renderCase,
+                                                                double sampleRate,
+                                                                int blockSize,
+                                                                const juce::AudioChannelSet& channelLayout,
+                                                                juce::AudioProcessor::ProcessingPrecision precision,
+                                                                juce::String& error)
+{
+    auto plugin = createVst3Instance(pluginPath, cacheOptions, sampleRate, blockSize, error);
+    if (plugin == nullptr)
+        return nullptr;
+
+    // The precision is picked up by prepareToPlay, so it has to be set first.
+    if (precision == juce::AudioProcessor::doublePrecision)
+    {
+        if (!plugin->supportsDoublePrecisionProcessing())
+        {
+            error = "Plugin does not support double precision processing: " + pluginPath.getFullPathName();
+            return nullptr;
+        }
+
+        plugin->setProcessingPrecision(precision);
+    }
+
+    if (!prepareInstanceForCase(*plugin, renderCase, sampleRate, blockSize, channelLayout, error))
+        return nullptr;
+
+    return plugin;
+}
+
+int getProcessChannelCount(const juce::AudioPluginInstance& plugin, int channels)
+{
+    return std::max({ channels, plugin.getTotalNumInputChannels(), plugin.getTotalNumOutputChannels(), 1 });
+}
+
+template <typename SampleType>
+void runWarmup(juce::AudioPluginInstance& plugin,
+               juce::AudioBuffer<SampleType>& ioBlock,
+               juce::MidiBuffer& midi,
+               double sampleRate,
+               int warmupMs)
+{
+    const int blockSize = ioBlock.getNumSamples();
+    const int warmupSamples = static_cast<int>(std::round(sampleRate * static_cast<double>(warmupMs) / 1000.0));
+
+    for (int pos = 0; pos < warmupSamples; pos += blockSize)
+    {
+        ioBlock.clear();
+        plugin.processBlock(ioBlock, midi);
+        midi.clear();
+    }
+}
+
+// Copies up to numSamples input samples starting at pos into the first
+// channels of ioBlock, reusing the last source channel when the file has fewer
+// channels than requested. Samples past the end of the input stay silent.
+template <typename SampleType>
+bool readInputBlock(juce::AudioFormatReader& reader,
+                    juce::AudioBuffer<float>& readBlock,
+                    juce::AudioBuffer<SampleType>& ioBlock,
+                    int channels,
+                    juce::int64 pos,
+                    int numSamples)
+{
+    const int copyCount = static_cast<int>(juce::jlimit<juce::int64>(0, numSamples, reader.lengthInSamples - pos));
+    if (copyCount <= 0)
+        return true;
+
+    const int readerChannels = readBlock.getNumChannels();
+    if (!reader.read(readBlock.getArrayOfWritePointers(), readerChannels, pos, copyCount))
+        return false;
+
+    for (int channel = 0; channel < std::min(channels, ioBlock.getNumChannels()); ++channel)
+    {
+        const float* source = readBlock.getReadPointer(std::min(channel, readerChannels - 1));
+        std::copy(source, source + copyCount, ioBlock.getWritePointer(channel));
+    }
+
+    return true;
+}
+
+template <typename SampleType>
+void accumulateRenderStats(const juce::AudioBuffer<SampleType>& block, int channels, int numSamples, RenderStats& stats)
+{
+    for (int channel = 0; channel < channels; ++channel)
+    {
+        const SampleType* samples = block.getReadPointer(channel);
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const double value = static_cast<double>(samples[i]);
+            if (!std::isfinite(value))
+            {
+                stats.hasNaNOrInf = true;
+                continue;
+            }
+
+            stats.peak = std::max(stats.peak, std::abs(value));
+            stats.sumSquares += value * value;
+        }
+    }
+
+    stats.numSamples += numSamples;
+}
+
+LevelMetrics levelsFromStats(const RenderStats& stats, int channels)
+{
+    LevelMetrics metrics;
+    const double count = static_cast<double>(channels) * static_cast<double>(stats.numSamples);
+    if (count <= 0.0)
+        return metrics;
+
+    metrics.peakDbfs = juce::Decibels::gainToDecibels(static_cast<float>(stats.peak), -160.0f);
+    metrics.rmsDbfs = juce::Decibels::gainToDecibels(static_cast<float>(std::sqrt(stats.sumSquares / count)), -160.0f);
+    return metrics;
+}
+
+// Streams renderSamples samples of the reader through an already prepared
+// plugin and hands every processed block to the writer. Memory use is bounded
+// by the block size and the writer's ring regardless of the input length.
+bool renderToWriter(juce::AudioPluginInstance& plugin,
+                    juce::AudioBuffer<float>& ioBlock,
+                    Automation& automation,
+                    juce::AudioFormatReader& reader,
+                    BackgroundWriter& writer,
+                    int channels,
+                    juce::int64 renderSamples,
+                    RenderStats& stats,
+                    const RtCheck& rtCheck,
+                    juce::String& error)
+{
+    const int blockSize = ioBlock.getNumSamples();
+    juce::AudioBuffer<float> readBlock(static_cast<int>(reader.numChannels), blockSize);
+    juce::MidiBuffer midi;
+
+    for (juce::int64 pos = 0; pos < renderSamples; pos += blockSize)
+    {
+        const int thisBlock = static_cast<int>(std::min<juce::int64>(blockSize, renderSamples - pos));
+        ioBlock.clear();
+
+        if (!readInputBlock(reader, readBlock, ioBlock, channels, pos, thisBlock))
+        {
+            error = "Failed to read input audio at sample " + juce::String(pos);
+            return false;
+        }
+
+        processHostBlock(plugin, ioBlock, thisBlock, pos, automation, midi, rtCheck);
+
+        accumulateRenderStats(ioBlock, channels, thisBlock, stats);
+
+        if (!writer.write(ioBlock.getArrayOfReadPointers(), thisBlock))
+        {
+            error = "Failed while writing output at sample " + juce::String(pos);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+struct PrecisionComparison
+{
+    double floatSeconds = 0.0;
+    double doubleSeconds = 0.0;
+    double maxAbsDifference = 0.0;
+    double differenceSumSquares = 0.0;
+    double doubleSumSquares = 0.0;
+    juce::int64 numSamples = 0;
+};
+
+// Like renderToWriter, but renders the same input through a double precision
+// instance (whose output is written) and a single precision one in lock step,
+// timing both and measuring how far the float output strays from the double.
+bool renderPrecisionComparison(juce::AudioPluginInstance& doublePlugin,
+                               juce::AudioPluginInstance& floatPlugin,
+                               juce::AudioBuffer<double>& doubleBlock,
+                               juce::AudioBuffer<float>& floatBlock,
+                               Automation& doubleAutomation,
+                               Automation& floatAutomation,
+                               juce::AudioFormatReader& reader,
+                               BackgroundWriter& writer,
+                               int channels,
+                               juce::int64 renderSamples,
+                               RenderStats& stats,
+                               PrecisionComparison& comparison,
+                               const RtCheck& rtCheck,
+                               juce::String& error)
+{
+    const int blockSize = doubleBlock.getNumSamples();
+    const int compareChannels = std::min({ channels, doubleBlock.getNumChannels(), floatBlock.getNumChannels() });
+    juce::AudioBuffer<float> readBlock(static_cast<int>(reader.numChannels), blockSize);
+    juce::AudioBuffer<float> writeBlock(channels, blockSize);
+    juce::MidiBuffer midi;
+
+    for (juce::int64 pos = 0; pos < renderSamples; pos += blockSize)
+    {
+        const int thisBlock = static_cast<int>(std::min<juce::int64>(blockSize, renderSamples - pos));
+        doubleBlock.clear();
+        floatBlock.clear();
+
+        if (!readInputBlock(reader, readBlock, doubleBlock, channels, pos, thisBlock))
+        {
+            error = "Failed to read input audio at sample " + juce::String(pos);
+            return false;
+        }
+
+        for (int channel = 0; channel < compareChannels; ++channel)
+        {
+            const double* source = doubleBlock.getReadPointer(channel);
+            std::transform(source, source + thisBlock, floatBlock.getWritePointer(channel),
+                           [](double sample) { return static_cast<float>(sample); });
+        }
+
+        const auto doubleStart = std::chrono::steady_clock::now();
+        processHostBlock(doublePlugin, doubleBlock, thisBlock, pos, doubleAutomation, midi, rtCheck);
+        const auto floatStart = std::chrono::steady_clock::now();
+        processHostBlock(floatPlugin, floatBlock, thisBlock, pos, floatAutomation, midi, RtCheck {});
+        const auto floatEnd = std::chrono::steady_clock::now();
+
+        comparison.doubleSeconds += std::chrono::duration<double>(floatStart - doubleStart).count();
+        comparison.floatSeconds += std::chrono::duration<double>(floatEnd - floatStart).count();
+
+        for (int channel = 0; channel < compareChannels; ++channel)
+        {
+            const double* reference = doubleBlock.getReadPointer(channel);
+            const float* single = floatBlock.getReadPointer(channel);
+
+            for (int i = 0; i < thisBlock; ++i)
+            {
+                const double difference = static_cast<double>(single[i]) - reference[i];
+                comparison.maxAbsDifference = std::max(comparison.maxAbsDifference, std::abs(difference));
+                comparison.differenceSumSquares += difference * difference;
+                comparison.doubleSumSquares += reference[i] * reference[i];
+            }
+        }
+
+        comparison.numSamples += thisBlock;
+
+        accumulateRenderStats(doubleBlock, channels, thisBlock, stats);
+
+        for (int channel = 0; channel < std::min(channels, doubleBlock.getNumChannels()); ++channel)
+        {
+            const double* source = doubleBlock.getReadPointer(channel);
+            std::transform(source, source + thisBlock, writeBlock.getWritePointer(channel),
+                           [](double sample) { return static_cast<float>(sample); });
+        }
+
+        if (!writer.write(writeBlock.getArrayOfReadPointers(), thisBlock))
+        {
+            error = "Failed while writing output at sample " + juce::String(pos);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+juce::var makePrecisionObject(const PrecisionComparison& comparison, int channels, double sampleRate)
+{
+    const double audioSeconds = static_cast<double>(comparison.numSamples) / sampleRate;
+    const double count = static_cast<double>(channels) * static_cast<double>(comparison.numSamples);
+
+    auto makeTimingEntry = [audioSeconds](double processSeconds)
+    {
+        juce::DynamicObject::Ptr entry = new juce::DynamicObject();
+        entry->setProperty("processSeconds", processSeconds);
+        entry->setProperty("realtimeFactor", processSeconds > 0.0 ? audioSeconds / processSeconds : 0.0);
+        return juce::var(entry.get());
+    };
+
+    auto toDb = [](double gain)
+    {
+        return gain > 0.0 ? 20.0 * std::log10(gain) : -400.0;
+    };
+
+    const double rmsDifference = count > 0.0 ? std::sqrt(comparison.differenceSumSquares / count) : 0.0;
+    const double snrDb = comparison.differenceSumSquares > 0.0
+                           ? 10.0 * std::log10(comparison.doubleSumSquares / comparison.differenceSumSquares)
+                           : 400.0;
+
+    juce::DynamicObject::Ptr differenceObject = new juce::DynamicObject();
+    differenceObject->setProperty("maxAbs", comparison.maxAbsDifference);
+    differenceObject->setProperty("maxAbsDbfs", toDb(comparison.maxAbsDifference));
+    differenceObject->setProperty("rmsDbfs", toDb(rmsDifference));
+    differenceObject->setProperty("snrDb", snrDb);
+
+    juce::DynamicObject::Ptr precisionObject = new juce::DynamicObject();
+    precisionObject->setProperty("numSamples", comparison.numSamples);
+    precisionObject->setProperty("float", makeTimingEntry(comparison.floatSeconds));
+    precisionObject->setProperty("double", makeTimingEntry(comparison.doubleSeconds));
+    precisionObject->setProperty("doubleToFloatTimeRatio",
+                                 comparison.floatSeconds > 0.0 ? comparison.doubleSeconds / comparison.floatSeconds : 0.0);
+    precisionObject->setProperty("floatVsDouble", juce::var(differenceObject.get()));
+    return juce::var(precisionObject.get());
+}
+
+// Average of the first `channels` channels of buffer.
+std::vector<float> makeMonoSum(const juce::AudioBuffer<float>& buffer, int channels)
+{
+    channels = std::min(channels, buffer.getNumChannels());
+    const int numSamples = buffer.getNumSamples();
+    std::vector<float> mono(static_cast<size_t>(numSamples), 0.0f);
+
+    if (channels <= 0 || numSamples <= 0)
+        return mono;
+
+    const float scale = 1.0f / static_cast<float>(channels);
+    for (int channel = 0; channel < channels; ++channel)
+    {
+        const float* samples = buffer.getReadPointer(channel);
+        for (int i = 0; i < numSamples; ++i)
+            mono[static_cast<size_t>(i)] += samples[i] * scale;
+    }
+
+    return mono;
+}
+
+// Normalised correlation magnitude at a single lag, accumulated directly in
+// double precision. The FFT search below uses this to settle near-ties.
+bool scoreLagExactly(const std::vector<float>& dry, const std::vector<float>& wet, int lag, double& outScore)
+{
+    const auto drySize = static_cast<juce::int64>(dry.size());
+    const auto wetSize = static_cast<juce::int64>(wet.size());
+    const juce::int64 dryStart = lag < 0 ? -static_cast<juce::int64>(lag) : 0;
+    const juce::int64 wetStart = lag > 0 ? static_cast<juce::int64>(lag) : 0;
+    const juce::int64 overlap = std::min(drySize - dryStart, wetSize - wetStart);
+
+    if (overlap <= 0)
+        return false;
+
+    double dot = 0.0;
+    double dryEnergy = 0.0;
+    double wetEnergy = 0.0;
+
+    for (juce::int64 i = 0; i < overlap; ++i)
+    {
+        const double drySample = static_cast<double>(dry[static_cast<size_t>(dryStart + i)]);
+        const double wetSample = static_cast<double>(wet[static_cast<size_t>(wetStart + i)]);
+        dot += drySample * wetSample;
+        dryEnergy += drySample * drySample;
+        wetEnergy += wetSample * wetSample;
+    }
+
+    if (dryEnergy <= 0.0 || wetEnergy <= 0.0)
+        return false;
+
+    outScore = std::abs(dot / std::sqrt(dryEnergy * wetEnergy));
+    return true;
+}
+
+// Computes sum_j dry[j] * wet[j + lag] for every lag in [-maxLag, maxLag]
+// (index lag + maxLag of the result). The dry signal is cut into segments and
+// each one is correlated against the wet samples it can reach, overlap-save
+// style, so the FFT size depends on the lag range rather than the file length.
+std::vector<double> crossCorrelateByFft(const std::vector<float>& dry, const std::vector<float>& wet, int maxLag)
+{
+    const int numLags = 2 * maxLag + 1;
+
+    int order = 12;
+    while ((juce::int64 { 1 } << order) < 4 * static_cast<juce::int64>(numLags))
+        ++order;
+
+    juce::dsp::FFT fft(order);
+    const int fftSize = fft.getSize();
+    const int segmentSize = fftSize - 2 * maxLag;
+
+    std::vector<float> dryBlock(static_cast<size_t>(2 * fftSize));
+    std::vector<float> wetBlock(static_cast<size_t>(2 * fftSize));
+    std::vector<juce::dsp::Complex<float>> spectrum(static_cast<size_t>(fftSize));
+    std::vector<juce::dsp::Complex<float>> segmentCorrelation(static_cast<size_t>(fftSize));
+    std::vector<double> correlation(static_cast<size_t>(numLags), 0.0);
+
+    const auto drySize = static_cast<juce::int64>(dry.size());
+    const auto wetSize = static_cast<juce::int64>(wet.size());
+
+    for (juce::int64 segmentStart = 0; segmentStart < drySize; segmentStart += segmentSize)
+    {
+        const auto dryCount = static_cast<int>(std::min<juce::int64>(segmentSize, drySize - segmentStart));
+        const juce::int64 wetStart = segmentStart - maxLag;
+        const juce::int64 wetBegin = std::max<juce::int64>(0, wetStart);
+        const juce::int64 wetEnd = std::min<juce::int64>(wetSize, segmentStart + dryCount + maxLag);
+
+        if (wetEnd <= wetBegin)
+            continue;
+
+        std::fill(dryBlock.begin(), dryBlock.end(), 0.0f);
+        std::fill(wetBlock.begin(), wetBlock.end(), 0.0f);
+        std::copy_n(dry.begin() + segmentStart, dryCount, dryBlock.begin());
+        std::copy(wet.begin() + wetBegin, wet.begin() + wetEnd, wetBlock.begin() + (wetBegin - wetStart));
+
+        fft.performRealOnlyForwardTransform(dryBlock.data());
+        fft.performRealOnlyForwardTransform(wetBlock.data());
+
+        for (size_t bin = 0; bin < spectrum.size(); ++bin)
+        {
+            const juce::dsp::Complex<float> dryBin(dryBlock[2 * bin], dryBlock[2 * bin + 1]);
+            const juce::dsp::Complex<float> wetBin(wetBlock[2 * bin], wetBlock[2 * bin + 1]);
+            spectrum[bin] = std::conj(dryBin) * wetBin;
+        }
+
+        fft.perform(spectrum.data(), segmentCorrelation.data(), true);
+
+        for (size_t i = 0; i < correlation.size(); ++i)
+            correlation[i] += static_cast<double>(segmentCorrelation[i].real());
+    }
+
+    return correlation;
+}
+
+int detectLatencyByCrossCorrelation(const std::vector<float>& dry,
+                                    const std::vector<float>& wet,
+                                    int maxLagSamples)
+{
+    const auto drySize = static_cast<juce::int64>(dry.size());
+    const auto wetSize = static_cast<juce::int64>(wet.size());
+
+    if (drySize <= 0 || wetSize <= 0 || maxLagSamples < 0)
+        return 0;
+
+    // Lags beyond the longer signal never overlap, so there is nothing to search there.
+    const int maxLag = static_cast<int>(std::min<juce::int64>(maxLagSamples, std::max(drySize, wetSize) - 1));
+    const auto dots = crossCorrelateByFft(dry, wet, maxLag);
+
+    std::vector<double> dryPrefixEnergy(dry.size() + 1, 0.0);
+    std::vector<double> wetPrefixEnergy(wet.size() + 1, 0.0);
+    for (size_t i = 0; i < dry.size(); ++i)
+        dryPrefixEnergy[i + 1] = dryPrefixEnergy[i] + static_cast<double>(dry[i]) * static_cast<double>(dry[i]);
+    for (size_t i = 0; i < wet.size(); ++i)
+        wetPrefixEnergy[i + 1] = wetPrefixEnergy[i] + static_cast<double>(wet[i]) * static_cast<double>(wet[i]);
+
+    std::vector<double> approxScores(dots.size(), -1.0);
+    double bestApproxScore = -1.0;
+
+    for (int lag = -maxLag; lag <= maxLag; ++lag)
+    {
+        const juce::int64 dryStart = lag < 0 ? -static_cast<juce::int64>(lag) : 0;
+        const juce::int64 wetStart = lag > 0 ? static_cast<juce::int64>(lag) : 0;
+        const juce::int64 overlap = std::min(drySize - dryStart, wetSize - wetStart);
+
+        if (overlap <= 0)
+            continue;
+
+        const double dryEnergy = dryPrefixEnergy[static_cast<size_t>(dryStart + overlap)] - dryPrefixEnergy[static_cast<size_t>(dryStart)];
+        const double wetEnergy = wetPrefixEnergy[static_cast<size_t>(wetStart + overlap)] - wetPrefixEnergy[static_cast<size_t>(wetStart)];
+
+        if (dryEnergy <= 0.0 || wetEnergy <= 0.0)
+            continue;
+
+        const double score = std::abs(dots[static_cast<size_t>(lag + maxLag)]) / std::sqrt(dryEnergy * wetEnergy);
+        approxScores[static_cast<size_t>(lag + maxLag)] = score;
+        bestApproxScore = std::max(bestApproxScore, score);
+    }
+
+    if (bestApproxScore < 0.0)
+        return 0;
+
+    // The FFT scores carry single-precision rounding, which is enough to pick
+    // the winner but not to order lags whose scores are almost equal (periodic
+    // signals produce many of those). Every lag within the FFT error bound of
+    // the best one is rescored exactly, in ascending lag order with a strict
+    // comparison, which reproduces the result of the full direct search.
+    constexpr double fftScoreTolerance = 1.0e-4;
+
+    int bestLag = 0;
+    double bestScore = -1.0;
+
+    for (int lag = -maxLag; lag <= maxLag; ++lag)
+    {
+        if (approxScores[static_cast<size_t>(lag + maxLag)] < bestApproxScore - fftScoreTolerance)
+            continue;
+
+        double score = 0.0;
+        if (scoreLagExactly(dry, wet, lag, score) && score > bestScore)
+        {
+            bestScore = score;
+            bestLag = lag;
+        }
+    }
+
+    return bestLag;
+}
+
+struct AnalyzeSums
+{
+    RenderStats wet;
+    RenderStats delta;
+    double dot = 0.0;
+    double dryEnergy = 0.0;
+    double wetEnergy = 0.0;
+};
+
+constexpr int analyzeChunkSamples = 4096;
+constexpr int analyzeLanes = 4;
+
+// Copies source samples [sourceStart, sourceStart + numSamples) of the first
+// channels into dest, with zeros wherever that range lies outside the source.
+void stageAnalyzeChunk(const juce::AudioBuffer<float>& source,
+                       int channels,
+                       juce::int64 sourceStart,
+                       int numSamples,
+                       juce::AudioBuffer<float>& dest)
+{
+    const juce::int64 begin = std::max<juce::int64>(sourceStart, 0);
+    const juce::int64 end = std::min<juce::int64>(sourceStart + numSamples, source.getNumSamples());
+
+    for (int channel = 0; channel < channels; ++channel)
+    {
+        dest.clear(channel, 0, numSamples);
+
+        if (begin < end)
+        {
+            dest.copyFrom(channel,
+                          static_cast<int>(begin - sourceStart),
+                          source,
+                          channel,
+                          static_cast<int>(begin),
+                          static_cast<int>(end - begin));
+        }
+    }
+}
+
+// Peak, sum of squares and NaN/Inf flag for one channel of a chunk. NaN/Inf
+// samples are flagged and left out of the levels, as in render. The lanes are
+// independent accumulators so the loop vectorizes without reassociating sums.
+void accumulateChunkStats(const float* samples, int numSamples, RenderStats& stats)
+{
+    float peak[analyzeLanes] = {};
+    double sumSquares[analyzeLanes] = {};
+    int nonFinite[analyzeLanes] = {};
+
+    const int vectorEnd = numSamples - numSamples % analyzeLanes;
+    for (int i = 0; i < vectorEnd; i += analyzeLanes)
+    {
+        for (int lane = 0; lane < analyzeLanes; ++lane)
+        {
+            const float value = samples[i + lane];
+            const bool finite = (value - value) == 0.0f;
+            const float clean = finite ? value : 0.0f;
+            nonFinite[lane] += finite ? 0 : 1;
+            peak[lane] = std::max(peak[lane], std::abs(clean));
+            sumSquares[lane] += static_cast<double>(clean) * static_cast<double>(clean);
+        }
+    }
+
+    for (int i = vectorEnd; i < numSamples; ++i)
+    {
+        const float value = samples[i];
+        const bool finite = (value - value) == 0.0f;
+        const float clean = finite ? value : 0.0f;
+        nonFinite[0] += finite ? 0 : 1;
+        peak[0] = std::max(peak[0], std::abs(clean));
+        sumSquares[0] += static_cast<double>(clean) * static_cast<double>(clean);
+    }
+
+    for (int lane = 0; lane < analyzeLanes; ++lane)
+    {
+        stats.peak = std::max(stats.peak, static_cast<double>(peak[lane]));
+        stats.sumSquares += sumSquares[lane];
+        stats.hasNaNOrInf = stats.hasNaNOrInf || nonFinite[lane] != 0;
+    }
+}
+
+void accumulateChunkCorrelation(const float* x, const float* y, int numSamples, AnalyzeSums& sums)
+{
+    double dot[analyzeLanes] = {};
+    double energyX[analyzeLanes] = {};
+    double energyY[analyzeLanes] = {};
+
+    const int vectorEnd = numSamples - numSamples % analyzeLanes;
+    for (int i = 0; i < vectorEnd; i += analyzeLanes)
+    {
+        for (int lane = 0; lane < analyzeLanes; ++lane)
+        {
+            const double a = static_cast<double>(x[i + lane]);
+            const double b = static_cast<double>(y[i + lane]);
+            dot[lane] += a * b;
+            energyX[lane] += a * a;
+            energyY[lane] += b * b;
+        }
+    }
+
+    for (int i = vectorEnd; i < numSamples; ++i)
+    {
+        const double a = static_cast<double>(x[i]);
+        const double b = static_cast<double>(y[i]);
+        dot[0] += a * b;
+        energyX[0] += a * a;
+        energyY[0] += b * b;
+    }
+
+    for (int lane = 0; lane < analyzeLanes; ++lane)
+    {
+        sums.dot += dot[lane];
+        sums.dryEnergy += energyX[lane];
+        sums.wetEnergy += energyY[lane];
+    }
+}
+
+// Computes every analyze metric in a single sweep over dry and the wet signal
+// delayed by wetOffset samples, both zero padded to numSamples. Each chunk is
+// staged once into small aligned scratch buffers that stay in cache while the
+// levels, NaN/Inf flags, mono sums for the correlation and (when deltaWriter is
+// set) the null delta are computed from them, and the delta is streamed to the
+// writer, so no full-length copies are made.
+bool runFusedAnalyzePass(const juce::AudioBuffer<float>& dry,
+                         const juce::AudioBuffer<float>& wet,
+                         int channels,
+                         juce::int64 numSamples,
+                         int wetOffset,
+                         juce::AudioFormatWriter* deltaWriter,
+                         AnalyzeSums& sums,
+                         juce::String& error)
+{
+    juce::AudioBuffer<float> dryChunk(channels, analyzeChunkSamples);
+    juce::AudioBuffer<float> wetChunk(channels, analyzeChunkSamples);
+    juce::AudioBuffer<float> deltaChunk(channels, analyzeChunkSamples);
+    std::vector<float> dryMono(static_cast<size_t>(analyzeChunkSamples));
+    std::vector<float> wetMono(static_cast<size_t>(analyzeChunkSamples));
+    const float monoScale = 1.0f / static_cast<float>(channels);
+
+    for (juce::int64 pos = 0; pos < numSamples; pos += analyzeChunkSamples)
+    {
+        const int count = static_cast<int>(std::min<juce::int64>(analyzeChunkSamples, numSamples - pos));
+
+        stageAnalyzeChunk(dry, channels, pos, count, dryChunk);
+        stageAnalyzeChunk(wet, channels, pos + wetOffset, count, wetChunk);
+
+        std::fill(dryMono.begin(), dryMono.begin() + count, 0.0f);
+        std::fill(wetMono.begin(), wetMono.begin() + count, 0.0f);
+
+        for (int channel = 0; channel < channels; ++channel)
+        {
+            const float* drySamples = dryChunk.getReadPointer(channel);
+            const float* wetSamples = wetChunk.getReadPointer(channel);
+            float* deltaSamples = deltaChunk.getWritePointer(channel);
+
+            for (int i = 0; i < count; ++i)
+            {
+                dryMono[static_cast<size_t>(i)] += drySamples[i] * monoScale;
+                wetMono[static_cast<size_t>(i)] += wetSamples[i] * monoScale;
+                deltaSamples[i] = wetSamples[i] - drySamples[i];
+            }
+
+            accumulateChunkStats(wetSamples, count, sums.wet);
+
+            if (deltaWriter != nullptr)
+                accumulateChunkStats(deltaSamples, count, sums.delta);
+        }
+
+        accumulateChunkCorrelation(dryMono.data(), wetMono.data(), count, sums);
+
+        if (deltaWriter != nullptr && !deltaWriter->writeFromFloatArrays(deltaChunk.getArrayOfReadPointers(), channels, count))
+        {
+            error = "Failed while writing delta WAV data at sample " + juce::String(pos);
+            return false;
+        }
+    }
+
+    sums.wet.numSamples = numSamples;
+    sums.delta.numSamples = deltaWriter != nullptr ? numSamples : 0;
+    return true;
+}
+
+double correlationFromSums(const AnalyzeSums& sums)
+{
+    if (sums.dryEnergy <= 0.0 || sums.wetEnergy <= 0.0)
+        return 0.0;
+
+    return sums.dot / std::sqrt(sums.dryEnergy * sums.wetEnergy);
+}
+
+double percentileOfSorted(const std::vector<double>& sorted, double fraction)
+{
+    if (sorted.empty())
+        return 0.0;
+
+    // Nearest-rank percentile: the smallest value with at least `fraction` of the
+    // samples at or below it, so p99.9 of 1000 blocks is the single worst block.
+    const auto rank = static_cast<size_t>(std::ceil(fraction * static_cast<double>(sorted.size())));
+    return sorted[std::min(sorted.size() - 1, rank > 0 ? rank - 1 : 0)];
+}
+
+juce::var makeTimingHistogram(const std::vector<double>& sortedMicros)
+{
+    // Log-spaced buckets, four per octave, spanning the observed range.
+    constexpr double bucketsPerOctave = 4.0;
+    juce::Array<juce::var> buckets;
+
+    if (sortedMicros.empty())
+        return buckets;
+
+    const double minimum = std::max(sortedMicros.front(), 1.0e-3);
+    auto bucketIndexFor = [&](double value)
+    {
+        return static_cast<int>(std::floor(std::log2(std::max(value, minimum)) * bucketsPerOctave));
+    };
+
+    const int firstBucket = bucketIndexFor(minimum);
+    const int lastBucket = bucketIndexFor(sortedMicros.back());
+    size_t next = 0;
+
+    for (int bucket = firstBucket; bucket <= lastBucket; ++bucket)
+    {
+        const double upperMicros = std::exp2(static_cast<double>(bucket + 1) / bucketsPerOctave);
+        int count = 0;
+
+        while (next < sortedMicros.size() && (bucket == lastBucket || bucketIndexFor(sortedMicros[next]) <= bucket))
+        {
+            ++count;
+            ++next;
+        }
+
+        juce::DynamicObject::Ptr bucketObject = new juce::DynamicObject();
+        bucketObject->setProperty("upperUs", upperMicros);
+        bucketObject->setProperty("count", count);
+        buckets.add(juce::var(bucketObject.get()));
+    }
+
+    return buckets;
+}
+
+int runDumpParams(const OptionMap& options)
+{
+    juce::String pluginPathText;
+    juce::String error;
+
+    if (!getRequiredOption(options, "plugin", pluginPathText, error))
+        return fail(error);
+
+    const juce::File pluginPath = resolvePath(pluginPathText);
+    auto instance = createVst3Instance(pluginPath, getPluginCacheOptions(options), 48000.0, 256, error);
+    if (instance == nullptr)
+        return fail(error);
+
+    auto& parameters = instance->getParameters();
+    for (int i = 0; i < parameters.size(); ++i)
+    {
+        auto* parameter = parameters.getUnchecked(i);
+        if (parameter == nullptr)
+            continue;
+
+        const auto name = parameter->getName(256);
+        const auto defaultNormalized = parameter->getDefaultValue();
+        std::cout << i << "\t" << name.toStdString() << "\t" << defaultNormalized << "\n";
+    }
+
+    return 0;
+}
+
+int runRender(const OptionMap& options)
+{
+    juce::String pluginPathText;
+    juce::String inputPathText;
+    juce::String outDirText;
+    juce::String casePathText;
+    juce::String error;
+    int sampleRate = 0;
+    int blockSize = 0;
+    juce::AudioChannelSet channelLayout;
+
+    if (!getRequiredOption(options, "plugin", pluginPathText, error)
+        || !getRequiredOption(options, "in", inputPathText, error)
+        || !getRequiredOption(options, "outdir", outDirText, error)
+        || !getRequiredIntOption(options, "sr", sampleRate, error)
+        || !getRequiredIntOption(options, "bs", blockSize, error)
+        || !getRequiredChannelLayoutOption(options, "ch", channelLayout, error))
+    {
+        return fail(error);
+    }
+
+    if (sampleRate <= 0 || blockSize <= 0)
+        return fail("sr and bs must be positive");
+
+    const int channels = channelLayout.size();
+
+    juce::String precisionText = "float";
+    getOptionalOption(options, "precision", precisionText);
+    if (precisionText != "float" && precisionText != "double")
+        return fail("--precision must be float or double");
+
+    const bool useDoublePrecision = precisionText == "double";
+
+    juce::String formatText = "24";
+    OutputFormat outputFormat = OutputFormat::pcm24;
+    getOptionalOption(options, "format", formatText);
+    if (!parseOutputFormat(formatText, outputFormat))
+        return fail("--format must be 16, 24, 32f or raw");
+
+    RtCheck rtCheck;
+    if (!createRtCheck(options, rtCheck, error))
+        return fail(error);
+
+    const juce::File pluginPath = resolvePath(pluginPathText);
+    const juce::File inputPath = resolvePath(inputPathText);
+    const juce::File outDir = resolvePath(outDirText);
+
+    RenderCase renderCase;
+    if (getOptionalOption(options, "case", casePathText))
+    {
+        const juce::File casePath = resolvePath(casePathText);
+        if (!parseRenderCaseFile(casePath, renderCase, error))
+            return fail(error);
+    }
+
+    auto reader = createAudioReader(inputPath, error);
+    if (reader == nullptr)
+        return fail(error);
+
+    if (std::abs(reader->sampleRate - static_cast<double>(sampleRate)) > 1.0e-6)
+    {
+        return fail("Input WAV sample rate (" + juce::String(reader->sampleRate)
+                    + ") does not match --sr (" + juce::String(sampleRate) + ")");
+    }
+
+    juce::int64 renderSamples = reader->lengthInSamples;
+    if (renderCase.renderSeconds.has_value())
+        renderSamples = static_cast<juce::int64>(std::llround(renderCase.renderSeconds.value() * static_cast<double>(sampleRate)));
+
+    if (renderSamples <= 0)
+        return fail("Render length must be positive");
+
+    auto plugin = createPreparedPlugin(pluginPath,
+                                       getPluginCacheOptions(options),
+                                       renderCase,
+                                       static_cast<double>(sampleRate),
+                                       blockSize,
+                                       channelLayout,
+                                       useDoublePrecision ? juce::AudioProcessor::doublePrecision
+                                                          : juce::AudioProcessor::singlePrecision,
+                                       error);
+    if (plugin == nullptr)
+        return fail(error);
+
+    Automation automation;
+    if (!buildAutomation(*plugin, renderCase, static_cast<double>(sampleRate), automation, error))
+        return fail(error);
+
+    applyAutomationAt(automation, 0);
+
+    if (!ensureDirectory(outDir, error))
+        return fail(error);
+
+    const juce::File wetPath = outDir.getChildFile("wet" + getOutputFileExtension(outputFormat));
+    auto writer = createBackgroundWriter(wetPath, outputFormat, static_cast<double>(sampleRate), channels, blockSize, error);
+    if (writer == nullptr)
+        return fail(error);
+
+    RenderStats stats;
+    juce::MidiBuffer midi;
+
+    if (useDoublePrecision)
+    {
+        // A single precision instance renders the same case alongside, as the
+        // reference for precision.json.
+        auto floatPlugin = createPreparedPlugin(pluginPath,
+                                                getPluginCacheOptions(options),
+                                                renderCase,
+                                                static_cast<double>(sampleRate),
+                                                blockSize,
+                                                channelLayout,
+                                                juce::AudioProcessor::singlePrecision,
+                                                error);
+        if (floatPlugin == nullptr)
+            return fail(error);
+
+        Automation floatAutomation;
+        if (!buildAutomation(*floatPlugin, renderCase, static_cast<double>(sampleRate), floatAutomation, error))
+            return fail(error);
+
+        applyAutomationAt(floatAutomation, 0);
+
+        juce::AudioBuffer<double> doubleBlock(getProcessChannelCount(*plugin, channels), blockSize);
+        juce::AudioBuffer<float> floatBlock(getProcessChannelCount(*floatPlugin, channels), blockSize);
+
+        runWarmup(*plugin, doubleBlock, midi, static_cast<double>(sampleRate), renderCase.warmupMs);
+        runWarmup(*floatPlugin, floatBlock, midi, static_cast<double>(sampleRate), renderCase.warmupMs);
+
+        PrecisionComparison comparison;
+        if (!renderPrecisionComparison(*plugin, *floatPlugin, doubleBlock, floatBlock, automation, floatAutomation,
+                                       *reader, *writer, channels, renderSamples, stats, comparison, rtCheck, error))
+        {
+            return fail(error);
+        }
+
+        floatPlugin->releaseResources();
+
+        const juce::File precisionPath = outDir.getChildFile("precision.json");
+        if (!writeJsonFile(precisionPath, makePrecisionObject(comparison, channels, static_cast<double>(sampleRate)), error))
+            return fail(error);
+
+        const double ratio = comparison.floatSeconds > 0.0 ? comparison.doubleSeconds / comparison.floatSeconds : 0.0;
+        std::cout << "Float vs double: max difference " << comparison.maxAbsDifference
+                  << ", double took " << ratio << "x the float processing time\n"
+                  << "Wrote: " << precisionPath.getFullPathName() << "\n";
+    }
+    else
+    {
+        juce::AudioBuffer<float> ioBlock(getProcessChannelCount(*plugin, channels), blockSize);
+        runWarmup(*plugin, ioBlock, midi, static_cast<double>(sampleRate), renderCase.warmupMs);
+
+        if (!renderToWriter(*plugin, ioBlock, automation, *reader, *writer, channels, renderSamples, stats, rtCheck, error))
+            return fail(error);
+    }
+
+    plugin->releaseResources();
+
+    if (!writer->finish(error))
+        return fail(error);
+
+    std::cout << "Wrote: " << wetPath.getFullPathName() << "\n";
+
+    juce::int64 rtViolations = 0;
+    if (!writeRtCheckReport(rtCheck, outDir, rtViolations, error))
+        return fail(error);
+
+    return rtViolations > 0 ? 3 : 0;
+}
+
+int runBench(const OptionMap& options)
+{
+    juce::String pluginPathText;
+    juce::String inputPathText;
+    juce::String outDirText;
+    juce::String casePathText;
+    juce::String error;
+    int sampleRate = 0;
+    int blockSize = 0;
+    juce::AudioChannelSet channelLayout;
+    std::optional<double> benchSeconds;
+    std::optional<double> sparseFraction;
+
+    if (!getRequiredOption(options, "plugin", pluginPathText, error)
+        || !getRequiredOption(options, "outdir", outDirText, error)
+        || !getRequiredIntOption(options, "sr", sampleRate, error)
+        || !getRequiredIntOption(options, "bs", blockSize, error)
+        || !getRequiredChannelLayoutOption(options, "ch", channelLayout, error)
+        || !getOptionalDoubleOption(options, "seconds", benchSeconds, error)
+        || !getOptionalDoubleOption(options, "sparse", sparseFraction, error))
+    {
+        return fail(error);
+    }
+
+    if (sampleRate <= 0 || blockSize <= 0)
+        return fail("sr and bs must be positive");
+
+    const int channels = channelLayout.size();
+
+    if (sparseFraction.has_value() && (sparseFraction.value() < 0.0 || sparseFraction.value() > 1.0))
+        return fail("--sparse must be between 0 and 1");
+
+    if (sparseFraction.has_value() && getFlag(options, "in"))
+        return fail("--sparse generates its own input and cannot be combined with --in");
+
+    RtCheck rtCheck;
+    if (!createRtCheck(options, rtCheck, error))
+        return fail(error);
+
+    RenderCase renderCase;
+    if (getOptionalOption(options, "case", casePathText))
+    {
+        if (!parseRenderCaseFile(resolvePath(casePathText), renderCase, error))
+            return fail(error);
+    }
+
+    std::unique_ptr<juce::AudioFormatReader> reader;
+    if (getOptionalOption(options, "in", inputPathText))
+    {
+        reader = createAudioReader(resolvePath(inputPathText), error);
+        if (reader == nullptr)
+            return fail(error);
+
+        if (std::abs(reader->sampleRate - static_cast<double>(sampleRate)) > 1.0e-6)
+        {
+            return fail("Input WAV sample rate (" + juce::String(reader->sampleRate)
+                        + ") does not match --sr (" + juce::String(sampleRate) + ")");
+        }
+    }
+
+    // Length precedence: --seconds, then the case file, then the input file,
+    // then a fixed default when benchmarking on generated noise.
+    double seconds = 10.0;
+    if (benchSeconds.has_value())
+        seconds = benchSeconds.value();
+    else if (renderCase.renderSeconds.has_value())
+        seconds = renderCase.renderSeconds.value();
+    else if (reader != nullptr)
+        seconds = static_cast<double>(reader->lengthInSamples) / static_cast<double>(sampleRate);
+
+    const auto benchSamples = static_cast<juce::int64>(std::llround(seconds * static_cast<double>(sampleRate)));
+    if (benchSamples <= 0)
+        return fail("Benchmark length must be positive");
+
+    auto plugin = createPreparedPlugin(resolvePath(pluginPathText),
+                                       getPluginCacheOptions(options),
+                                       renderCase,
+                                       static_cast<double>(sampleRate),
+                                       blockSize,
+                                       channelLayout,
+                                       juce::AudioProcessor::singlePrecision,
+                                       error);
+    if (plugin == nullptr)
+        return fail(error);
+
+    Automation automation;
+    if (!buildAutomation(*plugin, renderCase, static_cast<double>(sampleRate), automation, error))
+        return fail(error);
+
+    applyAutomationAt(automation, 0);
+
+    juce::AudioBuffer<float> ioBlock(getProcessChannelCount(*plugin, channels), blockSize);
+    juce::AudioBuffer<float> readBlock(reader != nullptr ? static_cast<int>(reader->numChannels) : 0, blockSize);
+    juce::MidiBuffer midi;
+    juce::Random random(0x5eed);
+
+    // Sparse noise is on for the first part of every one-second period, so
+    // onsets land mid-block unless the block size divides the sample rate.
+    const auto activeSamplesPerSecond = static_cast<juce::int64>(std::llround(sparseFraction.value_or(1.0) * static_cast<double>(sampleRate)));
+
+    runWarmup(*plugin, ioBlock, midi, static_cast<double>(sampleRate), renderCase.warmupMs);
+
+    // Every block is a full host block (the tail is zero padded) so that each
+    // timing sample is comparable against the same realtime deadline.
+    const auto numBlocks = static_cast<size_t>((benchSamples + blockSize - 1) / blockSize);
+    std::vector<double> blockMicros;
+    blockMicros.reserve(numBlocks);
+
+    // Timing split by whether the block's input was digital silence, which is
+    // where a plugin that skips silent input saves its time.
+    int silentInputBlocks = 0;
+    double silentInputMicros = 0.0;
+    double activeInputMicros = 0.0;
+
+    for (size_t block = 0; block < numBlocks; ++block)
+    {
+        const auto pos = static_cast<juce::int64>(block) * blockSize;
+        ioBlock.clear();
+
+        if (reader != nullptr)
+        {
+            if (!readInputBlock(*reader, readBlock, ioBlock, channels, pos, blockSize))
+                return fail("Failed to read audio samples from: " + inputPathText);
+        }
+        else
+        {
+            for (int channel = 0; channel < std::min(channels, ioBlock.getNumChannels()); ++channel)
+            {
+                auto* samples = ioBlock.getWritePointer(channel);
+                for (int i = 0; i < blockSize; ++i)
+                {
+                    const bool active = (pos + i) % sampleRate < activeSamplesPerSecond;
+                    samples[i] = active ? 0.25f * (2.0f * random.nextFloat() - 1.0f) : 0.0f;
+                }
+            }
+        }
+
+        const bool inputSilent = ioBlock.getMagnitude(0, blockSize) == 0.0f;
+
+        // With automation this includes the sub-block splitting and parameter
+        // changes, which is the cost a host would see for the same block.
+        const auto start = std::chrono::steady_clock::now();
+        processHostBlock(*plugin, ioBlock, blockSize, pos, automation, midi, rtCheck);
+        const auto end = std::chrono::steady_clock::now();
+
+        const auto micros = std::chrono::duration<double, std::micro>(end - start).count();
+        blockMicros.push_back(micros);
+
+        if (inputSilent)
+        {
+            ++silentInputBlocks;
+            silentInputMicros += micros;
+        }
+        else
+        {
+            activeInputMicros += micros;
+        }
+    }
+
+    plugin->releaseResources();
+
+    const double blockDurationMicros = 1.0e6 * static_cast<double>(blockSize) / static_cast<double>(sampleRate);
+    double totalMicros = 0.0;
+    int deadlineMisses = 0;
+    for (const double micros : blockMicros)
+    {
+        totalMicros += micros;
+        if (micros > blockDurationMicros)
+            ++deadlineMisses;
+    }
+
+    std::vector<double> sorted(blockMicros);
+    std::sort(sorted.begin(), sorted.end());
+
+    const double minMicros = sorted.front();
+    const double medianMicros = percentileOfSorted(sorted, 0.5);
+    const double p99Micros = percentileOfSorted(sorted, 0.99);
+    const double p999Micros = percentileOfSorted(sorted, 0.999);
+    const double maxMicros = sorted.back();
+    const double meanMicros = totalMicros / static_cast<double>(sorted.size());
+
+    auto realtimeFactor = [blockDurationMicros](double micros)
+    {
+        return micros > 0.0 ? blockDurationMicros / micros : 0.0;
+    };
+
+    juce::DynamicObject::Ptr timingObject = new juce::DynamicObject();
+    timingObject->setProperty("minUs", minMicros);
+    timingObject->setProperty("medianUs", medianMicros);
+    timingObject->setProperty("meanUs", meanMicros);
+    timingObject->setProperty("p99Us", p99Micros);
+    timingObject->setProperty("p999Us", p999Micros);
+    timingObject->setProperty("maxUs", maxMicros);
+
+    juce::DynamicObject::Ptr realtimeObject = new juce::DynamicObject();
+    realtimeObject->setProperty("overall", realtimeFactor(meanMicros));
+    realtimeObject->setProperty("median", realtimeFactor(medianMicros));
+    realtimeObject->setProperty("p99", realtimeFactor(p99Micros));
+    realtimeObject->setProperty("p999", realtimeFactor(p999Micros));
+    realtimeObject->setProperty("worst", realtimeFactor(maxMicros));
+
+    juce::DynamicObject::Ptr benchObject = new juce::DynamicObject();
+    benchObject->setProperty("plugin", resolvePath(pluginPathText).getFullPathName());
+    benchObject->setProperty("input", reader != nullptr ? resolvePath(inputPathText).getFullPathName()
+                                                        : juce::String(sparseFraction.has_value() ? "sparse noise" : "noise"));
+    benchObject->setProperty("sampleRate", sampleRate);
+    benchObject->setProperty("blockSize", blockSize);
+    benchObject->setProperty("channels", channels);
+    benchObject->setProperty("layout", channelLayout.getDescription());
+    benchObject->setProperty("automationLanes", static_cast<int>(automation.lanes.size()));
+    benchObject->setProperty("rtCheck", rtCheck.isEnabled());
+    benchObject->setProperty("numBlocks", static_cast<juce::int64>(sorted.size()));
+    benchObject->setProperty("blockDurationUs", blockDurationMicros);
+    benchObject->setProperty("deadlineMisses", deadlineMisses);
+    benchObject->setProperty("processBlockUs", juce::var(timingObject.get()));
+    benchObject->setProperty("realtimeFactor", juce::var(realtimeObject.get()));
+    benchObject->setProperty("histogram", makeTimingHistogram(sorted));
+
+    // The saving is measured against running every block at the cost of an
+    // active one, i.e. what the plugin would cost without skipping silence.
+    const auto activeInputBlocks = static_cast<int>(sorted.size()) - silentInputBlocks;
+    const double silentInputMeanMicros = silentInputBlocks > 0 ? silentInputMicros / silentInputBlocks : 0.0;
+    const double activeInputMeanMicros = activeInputBlocks > 0 ? activeInputMicros / activeInputBlocks : 0.0;
+    const double savedFraction = activeInputMeanMicros > 0.0
+                                   ? 1.0 - totalMicros / (activeInputMeanMicros * static_cast<double>(sorted.size()))
+                                   : 0.0;
+
+    juce::DynamicObject::Ptr silenceObject = new juce::DynamicObject();
+    silenceObject->setProperty("silentInputBlocks", silentInputBlocks);
+    silenceObject->setProperty("activeInputBlocks", activeInputBlocks);
+    silenceObject->setProperty("silentInputMeanUs", silentInputMeanMicros);
+    silenceObject->setProperty("activeInputMeanUs", activeInputMeanMicros);
+    silenceObject->setProperty("savedPercent", 100.0 * savedFraction);
+    benchObject->setProperty("silence", juce::var(silenceObject.get()));
+
+    if (sparseFraction.has_value())
+        benchObject->setProperty("sparseFraction", sparseFraction.value());
+
+    const juce::File outDir = resolvePath(outDirText);
+    if (!ensureDirectory(outDir, error))
+        return fail(error);
+
+    const juce::File benchPath = outDir.getChildFile("bench.json");
+    if (!writeJsonFile(benchPath, juce::var(benchObject.get()), error))
+        return fail(error);
+
+    std::cout << "processBlock us: min " << minMicros << ", median " << medianMicros
+              << ", p99 " << p99Micros << ", p99.9 " << p999Micros << ", max " << maxMicros << "\n"
+              << "Realtime factor: " << realtimeFactor(meanMicros) << "x overall, "
+              << realtimeFactor(maxMicros) << "x worst block, " << deadlineMisses << " deadline misses\n";
+
+    if (silentInputBlocks > 0 && activeInputBlocks > 0)
+    {
+        std::cout << "Silent input: " << silentInputBlocks << " blocks, mean " << silentInputMeanMicros
+                  << " us vs " << activeInputMeanMicros << " us active (" << 100.0 * savedFraction << "% saved)\n";
+    }
+
+    std::cout << "Wrote: " << benchPath.getFullPathName() << "\n";
+
+    juce::int64 rtViolations = 0;
+    if (!writeRtCheckReport(rtCheck, outDir, rtViolations, error))
+        return fail(error);
+
+    return rtViolations > 0 ? 3 : 0;
+}
+
+juce::var makeTimingObject(const std::vector<double>& sortedMicros)
+{
+    double totalMicros = 0.0;
+    for (const double micros : sortedMicros)
+        totalMicros += micros;
+
+    juce::DynamicObject::Ptr timingObject = new juce::DynamicObject();
+    if (sortedMicros.empty())
+        return juce::var(timingObject.get());
+
+    timingObject->setProperty("minUs", sortedMicros.front());
+    timingObject->setProperty("medianUs", percentileOfSorted(sortedMicros, 0.5));
+    timingObject->setProperty("meanUs", totalMicros / static_cast<double>(sortedMicros.size()));
+    timingObject->setProperty("p99Us", percentileOfSorted(sortedMicros, 0.99));
+    timingObject->setProperty("maxUs", sortedMicros.back());
+    return juce::var(timingObject.get());
+}
+
+// Times getStateInformation and setStateInformation round trips on one
+// instance, the cost a host pays per plugin when saving and loading sessions.
+int runStateBench(const OptionMap& options)
+{
+    juce::String pluginPathText;
+    juce::String outDirText;
     juce::String casePathText;
     juce::String error;
-    int sampleRate = 0;
-    int blockSize = 0;
-    int channels = 0;
+    std::optional<int> iterationsOption;
+
+    if (!getRequiredOption(options, "plugin", pluginPathText, error)
+        || !getRequiredOption(options, "outdir", outDirText, error)
+        || !getOptionalIntOption(options, "iterations", iterationsOption, error))
+    {
+        return fail(error);
+    }
+
+    const int iterations = iterationsOption.value_or(1000);
+    if (iterations <= 0)
+        return fail("--iterations must be positive");
+
+    RenderCase renderCase;
+    if (getOptionalOption(options, "case", casePathText))
+    {
+        if (!parseRenderCaseFile(resolvePath(casePathText), renderCase, error))
+            return fail(error);
+    }
+
+    const juce::File pluginPath = resolvePath(pluginPathText);
+    auto plugin = createVst3Instance(pluginPath,
+                                     getPluginCacheOptions(options),
+                                     static_cast<double>(renderCase.sampleRate.value_or(48000)),
+                                     renderCase.blockSize.value_or(256),
+                                     error);
+    if (plugin == nullptr)
+        return fail(error);
+
+    if (!applyParameterMapByIndex(*plugin, renderCase.paramsByIndex, error)
+        || !applyParameterMapByName(*plugin, renderCase.paramsByName, error))
+    {
+        return fail(error);
+    }
+
+    juce::MemoryBlock reference;
+    plugin->getStateInformation(reference);
+
+    if (reference.isEmpty())
+        return fail("Plugin returned an empty state");
+
+    std::vector<double> saveMicros;
+    std::vector<double> loadMicros;
+    saveMicros.reserve(static_cast<size_t>(iterations));
+    loadMicros.reserve(static_cast<size_t>(iterations));
+
+    juce::MemoryBlock saved;
+    for (int i = 0; i < iterations; ++i)
+    {
+        const auto saveStart = std::chrono::steady_clock::now();
+        plugin->getStateInformation(saved);
+        const auto saveEnd = std::chrono::steady_clock::now();
+        plugin->setStateInformation(reference.getData(), static_cast<int>(reference.getSize()));
+        const auto loadEnd = std::chrono::steady_clock::now();
+
+        saveMicros.push_back(std::chrono::duration<double, std::micro>(saveEnd - saveStart).count());
+        loadMicros.push_back(std::chrono::duration<double, std::micro>(loadEnd - saveEnd).count());
+    }
+
+    juce::MemoryBlock roundTrip;
+    plugin->getStateInformation(roundTrip);
+    const bool roundTripStable = roundTrip == reference;
+
+    std::sort(saveMicros.begin(), saveMicros.end());
+    std::sort(loadMicros.begin(), loadMicros.end());
+
+    juce::DynamicObject::Ptr benchObject = new juce::DynamicObject();
+    benchObject->setProperty("plugin", pluginPath.getFullPathName());
+    benchObject->setProperty("iterations", iterations);
+    benchObject->setProperty("stateBytes", static_cast<juce::int64>(reference.getSize()));
+    benchObject->setProperty("roundTripStable", roundTripStable);
+    benchObject->setProperty("saveUs", makeTimingObject(saveMicros));
+    benchObject->setProperty("loadUs", makeTimingObject(loadMicros));
+
+    const juce::File outDir = resolvePath(outDirText);
+    if (!ensureDirectory(outDir, error))
+        return fail(error);
+
+    const juce::File benchPath = outDir.getChildFile("state_bench.json");
+    if (!writeJsonFile(benchPath, juce::var(benchObject.get()), error))
+        return fail(error);
+
+    std::cout << "State: " << reference.getSize() << " bytes, round trip " << (roundTripStable ? "stable" : "CHANGED") << "\n"
+              << "save us: median " << percentileOfSorted(saveMicros, 0.5) << ", p99 " << percentileOfSorted(saveMicros, 0.99) << "\n"
+              << "load us: median " << percentileOfSorted(loadMicros, 0.5) << ", p99 " << percentileOfSorted(loadMicros, 0.99) << "\n"
+              << "Wrote: " << benchPath.getFullPathName() << "\n";
+
+    return roundTripStable ? 0 : 1;
+}
+
+// Runs numJobs jobs across a pool of plugin instances, one worker thread per
+// instance. The VST3 lifecycle (bus layout, setupProcessing, activation and
+// reset) belongs on the message thread, so prepare(instance, job) and
+// finish(instance, job) run on the calling thread, and only
+// render(instance, job) runs on the instance's worker. When prepare returns
+// false the job is not rendered, but it is still finished.
+template <typename Prepare, typename Render, typename Finish>
+void runJobsOnInstancePool(std::vector<std::unique_ptr<juce::AudioPluginInstance>>& pool,
+                           size_t numJobs,
+                           Prepare&& prepare,
+                           Render&& render,
+                           Finish&& finish)
+{
+    struct WorkerSlot
+    {
+        size_t job = 0;
+        bool assigned = false;
+        bool done = false;
+    };
+
+    std::mutex mutex;
+    std::condition_variable jobAssigned;
+    std::condition_variable jobDone;
+    std::vector<WorkerSlot> slots(pool.size());
+    bool stopping = false;
+
+    std::vector<std::thread> workers;
+    for (size_t worker = 0; worker < pool.size(); ++worker)
+    {
+        workers.emplace_back([&, worker]
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            auto& slot = slots[worker];
+
+            for (;;)
+            {
+                jobAssigned.wait(lock, [&] { return slot.assigned || stopping; });
+                if (!slot.assigned)
+                    return;
+
+                const size_t job = slot.job;
+                lock.unlock();
+                render(*pool[worker], job);
+                lock.lock();
+
+                slot.assigned = false;
+                slot.done = true;
+                jobDone.notify_one();
+            }
+        });
+    }
+
+    size_t nextJob = 0;
+    size_t busyWorkers = 0;
+
+    // Prepares jobs for an idle worker until one is handed over, finishing
+    // any whose preparation failed straight away.
+    auto assignNextJob = [&](size_t worker)
+    {
+        while (nextJob < numJobs)
+        {
+            const size_t job = nextJob++;
+            if (!prepare(*pool[worker], job))
+            {
+                finish(*pool[worker], job);
+                continue;
+            }
+
+            const std::lock_guard<std::mutex> lock(mutex);
+            slots[worker].job = job;
+            slots[worker].assigned = true;
+            ++busyWorkers;
+            jobAssigned.notify_all();
+            return;
+        }
+    };
+
+    for (size_t worker = 0; worker < pool.size(); ++worker)
+        assignNextJob(worker);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (busyWorkers > 0)
+    {
+        jobDone.wait(lock, [&] { return std::any_of(slots.begin(), slots.end(), [](const WorkerSlot& slot) { return slot.done; }); });
+
+        for (size_t worker = 0; worker < slots.size(); ++worker)
+        {
+            if (!slots[worker].done)
+                continue;
+
+            slots[worker].done = false;
+            --busyWorkers;
+            const size_t job = slots[worker].job;
+
+            lock.unlock();
+            finish(*pool[worker], job);
+            assignNextJob(worker);
+            lock.lock();
+        }
+    }
+
+    stopping = true;
+    jobAssigned.notify_all();
+    lock.unlock();
+
+    for (auto& worker : workers)
+        worker.join();
+}
+
+struct SuiteJob
+{
+    size_t resultIndex = 0;
+    RenderCase renderCase;
+    juce::File inputPath;
+    int sampleRate = 0;
+    int blockSize = 0;
+    juce::AudioChannelSet channelLayout;
+};
+
+struct SuiteResult
+{
+    juce::File caseFile;
+    juce::File wetPath;
+    int sampleRate = 0;
+    int blockSize = 0;
+    int channels = 0;
+    bool passed = false;
+    juce::String error;
+    double wallSeconds = 0.0;
+    RenderStats stats;
+};
+
+// Renders one case on an instance that runSuite has already prepared for it.
+bool runSuiteJob(juce::AudioPluginInstance& plugin,
+                 const SuiteJob& job,
+                 SharedInputReaders& readers,
+                 SuiteResult& result,
+                 juce::String& error)
+{
+    const auto reader = getInputReader(readers, job.inputPath, error);
+    if (reader == nullptr)
+        return false;
+
+    if (std::abs(reader->sampleRate - static_cast<double>(job.sampleRate)) > 1.0e-6)
+    {
+        error = "Input WAV sample rate (" + juce::String(reader->sampleRate)
+              + ") does not match case sample rate (" + juce::String(job.sampleRate) + ")";
+        return false;
+    }
+
+    juce::int64 renderSamples = reader->lengthInSamples;
+    if (job.renderCase.renderSeconds.has_value())
+        renderSamples = static_cast<juce::int64>(std::llround(job.renderCase.renderSeconds.value() * static_cast<double>(job.sampleRate)));
+
+    if (renderSamples <= 0)
+    {
+        error = "Render length must be positive";
+        return false;
+    }
+
+    const auto sampleRate = static_cast<double>(job.sampleRate);
+
+    Automation automation;
+    if (!buildAutomation(plugin, job.renderCase, sampleRate, automation, error))
+        return false;
+
+    applyAutomationAt(automation, 0);
+
+    juce::AudioBuffer<float> ioBlock(getProcessChannelCount(plugin, job.channelLayout.size()), job.blockSize);
+    juce::MidiBuffer midi;
+    runWarmup(plugin, ioBlock, midi, sampleRate, job.renderCase.warmupMs);
+
+    if (!ensureDirectory(result.wetPath.getParentDirectory(), error))
+        return false;
+
+    auto writer = createBackgroundWriter(result.wetPath, OutputFormat::pcm24, sampleRate, job.channelLayout.size(), job.blockSize, error);
+    if (writer == nullptr)
+        return false;
+
+    const bool rendered = renderToWriter(plugin, ioBlock, automation, *reader, *writer, job.channelLayout.size(), renderSamples, result.stats, RtCheck {}, error);
+    return rendered && writer->finish(error);
+}
+
+juce::var makeRenderMetricsObject(const RenderStats& stats, int channels)
+{
+    const auto levels = levelsFromStats(stats, channels);
+
+    juce::DynamicObject::Ptr metricsObject = new juce::DynamicObject();
+    metricsObject->setProperty("numSamples", stats.numSamples);
+    metricsObject->setProperty("wetPeakDbfs", levels.peakDbfs);
+    metricsObject->setProperty("wetRmsDbfs", levels.rmsDbfs);
+    metricsObject->setProperty("hasNaNOrInfWet", stats.hasNaNOrInf);
+    return juce::var(metricsObject.get());
+}
+
+juce::var makeSuiteResultObject(const SuiteResult& result)
+{
+
+    juce::DynamicObject::Ptr caseObject = new juce::DynamicObject();
+    caseObject->setProperty("name", result.caseFile.getFileNameWithoutExtension());
+    caseObject->setProperty("caseFile", result.caseFile.getFullPathName());
+    caseObject->setProperty("passed", result.passed);
+    if (result.error.isNotEmpty())
+        caseObject->setProperty("error", result.error);
+    caseObject->setProperty("wallSeconds", result.wallSeconds);
+    caseObject->setProperty("wet", result.wetPath.getFullPathName());
+    caseObject->setProperty("sampleRate", result.sampleRate);
+    caseObject->setProperty("blockSize", result.blockSize);
+    caseObject->setProperty("channels", result.channels);
+    caseObject->setProperty("metrics", makeRenderMetricsObject(result.stats, result.channels));
+    return juce::var(caseObject.get());
+}
+
+int runSuite(const OptionMap& options)
+{
+    juce::String casesDirText;
+    juce::String outDirText;
+    juce::String pluginOverrideText;
+    juce::String inputOverrideText;
+    juce::String error;
+    std::optional<int> jobsOption;
+    std::optional<int> sampleRateOption;
+    std::optional<int> blockSizeOption;
+    std::optional<juce::AudioChannelSet> channelLayoutOption;
 
-    if (!getRequiredOption(options, "plugin", pluginPathText, error)
-        || !getRequiredOption(options, "in", inputPathText, error)
+    if (!getRequiredOption(options, "cases", casesDirText, error)
         || !getRequiredOption(options, "outdir", outDirText, error)
-        || !getRequiredIntOption(options, "sr", sampleRate, error)
-        || !getRequiredIntOption(options, "bs", blockSize, error)
-        || !getRequiredIntOption(options, "ch", channels, error))
+        || !getOptionalIntOption(options, "jobs", jobsOption, error)
+        || !getOptionalIntOption(options, "sr", sampleRateOption, error)
+        || !getOptionalIntOption(options, "bs", blockSizeOption, error)
+        || !getOptionalChannelLayoutOption(options, "ch", channelLayoutOption, error))
     {
         return fail(error);
     }
 
-    if (sampleRate <= 0 || blockSize <= 0 || channels <= 0)
-        return fail("sr, bs, and ch must be positive");
+    const bool hasPluginOverride = getOptionalOption(options, "plugin", pluginOverrideText);
+    const bool hasInputOverride = getOptionalOption(options, "in", inputOverrideText);
+
+    const juce::File casesDir = resolvePath(casesDirText);
+    if (!casesDir.isDirectory())
+        return fail("Cases directory not found: " + casesDir.getFullPathName());
+
+    juce::Array<juce::File> caseFiles;
+    casesDir.findChildFiles(caseFiles, juce::File::findFiles, false, "*.json");
+    caseFiles.sort();
+
+    if (caseFiles.isEmpty())
+        return fail("No *.json case files found in: " + casesDir.getFullPathName());
 
-    const juce::File pluginPath = resolvePath(pluginPathText);
-    const juce::File inputPath = resolvePath(inputPathText);
     const juce::File outDir = resolvePath(outDirText);
+    if (!ensureDirectory(outDir, error))
+        return fail(error);
 
-    RenderCase renderCase;
-    if (getOptionalOption(options, "case", casePathText))
+    // Parse and validate every case up front on the main thread. A broken case
+    // is reported as a failure in the summary rather than aborting the suite.
+    std::vector<SuiteResult> results(static_cast<size_t>(caseFiles.size()));
+    std::vector<SuiteJob> jobs;
+    std::optional<juce::File> pluginPath;
+
+    for (size_t i = 0; i < results.size(); ++i)
     {
-        const juce::File casePath = resolvePath(casePathText);
-        if (!parseRenderCaseFile(casePath, renderCase, error))
+        auto& result = results[i];
+        result.caseFile = caseFiles.getReference(static_cast<int>(i));
+        result.wetPath = outDir.getChildFile(result.caseFile.getFileNameWithoutExtension()).getChildFile("wet.wav");
+
+        SuiteJob job;
+        job.resultIndex = i;
+
+        juce::String caseError;
+        if (!parseRenderCaseFile(result.caseFile, job.renderCase, caseError))
+        {
+            result.error = caseError;
+            continue;
+        }
+
+        const auto& renderCase = job.renderCase;
+        job.sampleRate = sampleRateOption.value_or(renderCase.sampleRate.value_or(0));
+        job.blockSize = blockSizeOption.value_or(renderCase.blockSize.value_or(0));
+        if (channelLayoutOption.has_value())
+            job.channelLayout = channelLayoutOption.value();
+        else if (renderCase.channels.value_or(0) > 0)
+            job.channelLayout = makeChannelSet(renderCase.channels.value());
+        result.sampleRate = job.sampleRate;
+        result.blockSize = job.blockSize;
+        result.channels = job.channelLayout.size();
+
+        const auto inputText = hasInputOverride ? std::optional<juce::String>(inputOverrideText) : renderCase.input;
+        const auto pluginText = hasPluginOverride ? std::optional<juce::String>(pluginOverrideText) : renderCase.plugin;
+
+        if (job.sampleRate <= 0 || job.blockSize <= 0 || result.channels <= 0)
+            result.error = "sampleRate, blockSize and channels must be set in the case or on the command line";
+        else if (!inputText.has_value())
+            result.error = "No input: set \"input\" in the case or pass --in";
+        else if (!pluginText.has_value())
+            result.error = "No plugin: set \"plugin\" in the case or pass --plugin";
+
+        if (result.error.isNotEmpty())
+            continue;
+
+        const auto casePluginPath = resolvePath(pluginText.value());
+        if (pluginPath.has_value() && casePluginPath != pluginPath.value())
+        {
+            return fail("All cases in a suite must use the same plugin (found " + pluginPath->getFullPathName()
+                        + " and " + casePluginPath.getFullPathName() + "); pass --plugin to override");
+        }
+
+        pluginPath = casePluginPath;
+        job.inputPath = resolvePath(inputText.value());
+        jobs.push_back(std::move(job));
+    }
+
+    const auto suiteStart = std::chrono::steady_clock::now();
+    int numWorkers = 0;
+
+    if (!jobs.empty())
+    {
+        numWorkers = jobsOption.value_or(juce::SystemStats::getNumCpus());
+        if (numWorkers <= 0)
+            return fail("--jobs must be positive");
+        numWorkers = std::min(numWorkers, static_cast<int>(jobs.size()));
+
+        // Instances are created, prepared for each case and released here on
+        // the message thread; the workers only render.
+        auto pool = createVst3InstancePool(pluginPath.value(),
+                                           getPluginCacheOptions(options),
+                                           numWorkers,
+                                           static_cast<double>(jobs.front().sampleRate),
+                                           jobs.front().blockSize,
+                                           error);
+        if (pool.empty())
             return fail(error);
+
+        SharedInputReaders readers;
+        std::vector<std::chrono::steady_clock::time_point> jobStarts(jobs.size());
+
+        runJobsOnInstancePool(
+            pool,
+            jobs.size(),
+            [&](juce::AudioPluginInstance& plugin, size_t jobIndex)
+            {
+                const auto& job = jobs[jobIndex];
+                auto& result = results[job.resultIndex];
+                jobStarts[jobIndex] = std::chrono::steady_clock::now();
+                return prepareInstanceForCase(plugin, job.renderCase, static_cast<double>(job.sampleRate),
+                                              job.blockSize, job.channelLayout, result.error);
+            },
+            [&](juce::AudioPluginInstance& plugin, size_t jobIndex)
+            {
+                const auto& job = jobs[jobIndex];
+                auto& result = results[job.resultIndex];
+
+                const bool rendered = runSuiteJob(plugin, job, readers, result, result.error);
+                if (rendered && result.stats.hasNaNOrInf)
+                    result.error = "NaN/Inf detected in output";
+
+                result.passed = rendered && !result.stats.hasNaNOrInf;
+            },
+            [&](juce::AudioPluginInstance& plugin, size_t jobIndex)
+            {
+                auto& result = results[jobs[jobIndex].resultIndex];
+                plugin.releaseResources();
+                result.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - jobStarts[jobIndex]).count();
+
+                std::cout << (result.passed ? "PASS " : "FAIL ") << result.caseFile.getFileName()
+                          << " (" << result.wallSeconds << " s)";
+                if (!result.passed)
+                    std::cout << ": " << result.error;
+                std::cout << "\n";
+            });
     }
 
-    AudioData dryAudio;
-    if (!readAudioFile(inputPath, dryAudio, error))
+    const double suiteSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - suiteStart).count();
+
+    juce::Array<juce::var> caseResults;
+    int numPassed = 0;
+    for (const auto& result : results)
+    {
+        if (result.passed)
+            ++numPassed;
+        caseResults.add(makeSuiteResultObject(result));
+    }
+
+    const int numFailed = static_cast<int>(results.size()) - numPassed;
+
+    juce::DynamicObject::Ptr summaryObject = new juce::DynamicObject();
+    summaryObject->setProperty("casesDir", casesDir.getFullPathName());
+    summaryObject->setProperty("plugin", pluginPath.has_value() ? pluginPath->getFullPathName() : juce::String());
+    summaryObject->setProperty("workers", numWorkers);
+    summaryObject->setProperty("wallSeconds", suiteSeconds);
+    summaryObject->setProperty("numCases", static_cast<int>(results.size()));
+    summaryObject->setProperty("passed", numPassed);
+    summaryObject->setProperty("failed", numFailed);
+    summaryObject->setProperty("cases", caseResults);
+
+    const juce::File summaryPath = outDir.getChildFile("suite_summary.json");
+    if (!writeJsonFile(summaryPath, juce::var(summaryObject.get()), error))
         return fail(error);
 
-    if (std::abs(dryAudio.sampleRate - static_cast<double>(sampleRate)) > 1.0e-6)
+    std::cout << numPassed << "/" << results.size() << " cases passed in " << suiteSeconds
+              << " s on " << numWorkers << " workers\n"
+              << "Wrote: " << summaryPath.getFullPathName() << "\n";
+
+    return numFailed == 0 ? 0 : 1;
+}
+
+struct SweepAxis
+{
+    juce::String parameterName;
+    int parameterIndex = -1;
+    std::vector<float> values;
+};
+
+struct SweepResult
+{
+    std::vector<float> values;
+    juce::File wetPath;
+    bool passed = false;
+    juce::String error;
+    double wallSeconds = 0.0;
+    RenderStats stats;
+};
+
+bool resolveSweepAxes(juce::AudioPluginInstance& instance,
+                      const std::vector<SweepAxisSpec>& specs,
+                      std::vector<SweepAxis>& outAxes,
+                      juce::String& error)
+{
+    auto& parameters = instance.getParameters();
+
+    for (const auto& spec : specs)
     {
-        return fail("Input WAV sample rate (" + juce::String(dryAudio.sampleRate)
-                    + ") does not match --sr (" + juce::String(sampleRate) + ")");
+        juce::AudioProcessorParameter* parameter = nullptr;
+
+        if (spec.nameLowercase.has_value())
+        {
+            parameter = findParameterByName(instance, spec.nameLowercase.value());
+            if (parameter == nullptr)
+            {
+                error = "Could not find swept plugin parameter named: " + juce::String(spec.nameLowercase.value());
+                return false;
+            }
+        }
+        else
+        {
+            const int index = spec.index.value_or(-1);
+            if (index < 0 || index >= parameters.size() || parameters.getUnchecked(index) == nullptr)
+            {
+                error = "Swept parameter index out of range: " + juce::String(index)
+                      + " (num parameters: " + juce::String(parameters.size()) + ")";
+                return false;
+            }
+            parameter = parameters.getUnchecked(index);
+        }
+
+        for (const auto& axis : outAxes)
+        {
+            if (axis.parameterIndex == parameter->getParameterIndex())
+            {
+                error = "Parameter '" + axis.parameterName + "' appears in more than one sweep axis";
+                return false;
+            }
+        }
+
+        outAxes.push_back({ parameter->getName(256), parameter->getParameterIndex(), spec.values });
     }
 
-    auto dryBuffer = copyChannels(dryAudio.buffer, channels);
+    return true;
+}
 
-    int renderSamples = dryBuffer.getNumSamples();
-    if (renderCase.renderSeconds.has_value())
-        renderSamples = static_cast<int>(std::round(renderCase.renderSeconds.value() * static_cast<double>(sampleRate)));
+// The case's fixed parameters as one index map, with paramsByName taking
+// precedence over paramsByIndex as in prepareInstanceForCase. Resolved once so
+// that sweep jobs never look parameters up by name.
+bool resolveBaseParameters(juce::AudioPluginInstance& instance,
+                           const RenderCase& renderCase,
+                           std::map<int, float>& outParameters,
+                           juce::String& error)
+{
+    outParameters = renderCase.paramsByIndex;
+
+    for (const auto& [nameLowercase, normalizedValue] : renderCase.paramsByName)
+    {
+        auto* parameter = findParameterByName(instance, nameLowercase);
+        if (parameter == nullptr)
+        {
+            error = "Could not find plugin parameter named: " + juce::String(nameLowercase);
+            return false;
+        }
+
+        outParameters[parameter->getParameterIndex()] = normalizedValue;
+    }
+
+    return true;
+}
+
+// Renders one grid point on an instance that was prepared once for the whole
+// sweep, and that runSweep has since given the point's parameters and reset.
+bool runSweepJob(juce::AudioPluginInstance& plugin,
+                 const RenderCase& renderCase,
+                 const juce::File& inputPath,
+                 SharedInputReaders& readers,
+                 double sampleRate,
+                 int channels,
+                 juce::int64 renderSamples,
+                 SweepResult& result,
+                 juce::String& error)
+{
+    const auto reader = getInputReader(readers, inputPath, error);
+    if (reader == nullptr)
+        return false;
+
+    Automation automation;
+    if (!buildAutomation(plugin, renderCase, sampleRate, automation, error))
+        return false;
+
+    applyAutomationAt(automation, 0);
+
+    juce::AudioBuffer<float> ioBlock(getProcessChannelCount(plugin, channels), plugin.getBlockSize());
+    juce::MidiBuffer midi;
+    runWarmup(plugin, ioBlock, midi, sampleRate, renderCase.warmupMs);
+
+    auto writer = createBackgroundWriter(result.wetPath, OutputFormat::pcm24, sampleRate, channels, plugin.getBlockSize(), error);
+    if (writer == nullptr)
+        return false;
+
+    const bool rendered = renderToWriter(plugin, ioBlock, automation, *reader, *writer, channels, renderSamples, result.stats, RtCheck {}, error);
+    return rendered && writer->finish(error);
+}
+
+juce::var makeSweepResultObject(const SweepResult& result, const std::vector<SweepAxis>& axes, size_t index, int channels)
+{
+    juce::DynamicObject::Ptr paramsObject = new juce::DynamicObject();
+    for (size_t axis = 0; axis < axes.size(); ++axis)
+        paramsObject->setProperty(axes[axis].parameterName, result.values[axis]);
+
+    juce::DynamicObject::Ptr combinationObject = new juce::DynamicObject();
+    combinationObject->setProperty("index", static_cast<juce::int64>(index));
+    combinationObject->setProperty("params", juce::var(paramsObject.get()));
+    combinationObject->setProperty("passed", result.passed);
+    if (result.error.isNotEmpty())
+        combinationObject->setProperty("error", result.error);
+    combinationObject->setProperty("wallSeconds", result.wallSeconds);
+    combinationObject->setProperty("wet", result.wetPath.getFullPathName());
+    combinationObject->setProperty("metrics", makeRenderMetricsObject(result.stats, channels));
+    return juce::var(combinationObject.get());
+}
+
+int runSweep(const OptionMap& options)
+{
+    juce::String casePathText;
+    juce::String outDirText;
+    juce::String pluginOverrideText;
+    juce::String inputOverrideText;
+    juce::String error;
+    std::optional<int> jobsOption;
+    std::optional<int> sampleRateOption;
+    std::optional<int> blockSizeOption;
+    std::optional<juce::AudioChannelSet> channelLayoutOption;
+
+    if (!getRequiredOption(options, "case", casePathText, error)
+        || !getRequiredOption(options, "outdir", outDirText, error)
+        || !getOptionalIntOption(options, "jobs", jobsOption, error)
+        || !getOptionalIntOption(options, "sr", sampleRateOption, error)
+        || !getOptionalIntOption(options, "bs", blockSizeOption, error)
+        || !getOptionalChannelLayoutOption(options, "ch", channelLayoutOption, error))
+    {
+        return fail(error);
+    }
+
+    const juce::File casePath = resolvePath(casePathText);
+    RenderCase renderCase;
+    if (!parseRenderCaseFile(casePath, renderCase, error))
+        return fail(error);
+
+    if (renderCase.sweep.empty())
+        return fail("Case file has no \"sweep\" axes: " + casePath.getFullPathName());
+
+    const int sampleRate = sampleRateOption.value_or(renderCase.sampleRate.value_or(0));
+    const int blockSize = blockSizeOption.value_or(renderCase.blockSize.value_or(0));
+    juce::AudioChannelSet channelLayout;
+    if (channelLayoutOption.has_value())
+        channelLayout = channelLayoutOption.value();
+    else if (renderCase.channels.value_or(0) > 0)
+        channelLayout = makeChannelSet(renderCase.channels.value());
+
+    const int channels = channelLayout.size();
+    if (sampleRate <= 0 || blockSize <= 0 || channels <= 0)
+        return fail("sampleRate, blockSize and channels must be set in the case or on the command line");
+
+    if (getOptionalOption(options, "plugin", pluginOverrideText))
+        renderCase.plugin = pluginOverrideText;
+    if (getOptionalOption(options, "in", inputOverrideText))
+        renderCase.input = inputOverrideText;
+
+    if (!renderCase.plugin.has_value())
+        return fail("No plugin: set \"plugin\" in the case or pass --plugin");
+    if (!renderCase.input.has_value())
+        return fail("No input: set \"input\" in the case or pass --in");
+
+    const juce::File pluginPath = resolvePath(renderCase.plugin.value());
+    const juce::File inputPath = resolvePath(renderCase.input.value());
+
+    SharedInputReaders readers;
+    juce::int64 renderSamples = 0;
+    {
+        const auto reader = getInputReader(readers, inputPath, error);
+        if (reader == nullptr)
+            return fail(error);
+
+        if (std::abs(reader->sampleRate - static_cast<double>(sampleRate)) > 1.0e-6)
+        {
+            return fail("Input WAV sample rate (" + juce::String(reader->sampleRate)
+                        + ") does not match sweep sample rate (" + juce::String(sampleRate) + ")");
+        }
+
+        renderSamples = reader->lengthInSamples;
+        if (renderCase.renderSeconds.has_value())
+            renderSamples = static_cast<juce::int64>(std::llround(renderCase.renderSeconds.value() * static_cast<double>(sampleRate)));
+    }
 
     if (renderSamples <= 0)
         return fail("Render length must be positive");
 
-    auto plugin = createVst3Instance(pluginPath, static_cast<double>(sampleRate), blockSize, error);
-    if (plugin == nullptr)
+    constexpr size_t maxCombinations = 1000000;
+    size_t numCombinations = 1;
+    for (const auto& axis : renderCase.sweep)
+    {
+        numCombinations *= axis.values.size();
+        if (numCombinations > maxCombinations)
+            return fail("Sweep expands to more than " + juce::String(static_cast<juce::int64>(maxCombinations)) + " combinations");
+    }
+
+    const juce::File outDir = resolvePath(outDirText);
+    if (!ensureDirectory(outDir, error))
+        return fail(error);
+
+    int numWorkers = jobsOption.value_or(juce::SystemStats::getNumCpus());
+    if (numWorkers <= 0)
+        return fail("--jobs must be positive");
+    numWorkers = std::min(numWorkers, static_cast<int>(numCombinations));
+
+    // Instances are created here on the message thread and prepared once for
+    // the whole sweep; only parameters change between grid points.
+    auto pool = createVst3InstancePool(pluginPath,
+                                       getPluginCacheOptions(options),
+                                       numWorkers,
+                                       static_cast<double>(sampleRate),
+                                       blockSize,
+                                       error);
+    if (pool.empty())
+        return fail(error);
+
+    std::vector<SweepAxis> axes;
+    std::map<int, float> baseParameters;
+    if (!resolveSweepAxes(*pool.front(), renderCase.sweep, axes, error)
+        || !resolveBaseParameters(*pool.front(), renderCase, baseParameters, error))
+    {
+        return fail(error);
+    }
+
+    // Expand the grid with the last axis varying fastest.
+    const int indexDigits = std::max(4, juce::String(static_cast<juce::int64>(numCombinations - 1)).length());
+    std::vector<SweepResult> results(numCombinations);
+    for (size_t combination = 0; combination < numCombinations; ++combination)
+    {
+        auto& result = results[combination];
+        result.values.resize(axes.size());
+
+        size_t remainder = combination;
+        for (size_t axis = axes.size(); axis-- > 0;)
+        {
+            const auto& values = axes[axis].values;
+            result.values[axis] = values[remainder % values.size()];
+            remainder /= values.size();
+        }
+
+        const auto name = "sweep_" + juce::String(static_cast<juce::int64>(combination)).paddedLeft('0', indexDigits);
+        result.wetPath = outDir.getChildFile(name + ".wav");
+    }
+
+    // Every instance is prepared, given each grid point's parameters, reset
+    // and released here on the message thread; the workers only render.
+    std::map<const juce::AudioPluginInstance*, juce::String> prepareErrors;
+    for (auto& instance : pool)
+    {
+        juce::String prepareError;
+        if (!prepareInstanceForCase(*instance, renderCase, static_cast<double>(sampleRate), blockSize, channelLayout, prepareError))
+            prepareErrors[instance.get()] = prepareError;
+    }
+
+    const auto sweepStart = std::chrono::steady_clock::now();
+    std::vector<std::chrono::steady_clock::time_point> jobStarts(results.size());
+
+    runJobsOnInstancePool(
+        pool,
+        results.size(),
+        [&](juce::AudioPluginInstance& plugin, size_t jobIndex)
+        {
+            auto& result = results[jobIndex];
+            jobStarts[jobIndex] = std::chrono::steady_clock::now();
+
+            if (const auto found = prepareErrors.find(&plugin); found != prepareErrors.end())
+            {
+                result.error = found->second;
+                return false;
+            }
+
+            auto parameters = baseParameters;
+            for (size_t axis = 0; axis < axes.size(); ++axis)
+                parameters[axes[axis].parameterIndex] = result.values[axis];
+
+            if (!applyParameterMapByIndex(plugin, parameters, result.error))
+                return false;
+
+            plugin.reset();
+            return true;
+        },
+        [&](juce::AudioPluginInstance& plugin, size_t jobIndex)
+        {
+            auto& result = results[jobIndex];
+            const bool rendered = runSweepJob(plugin,
+                                              renderCase,
+                                              inputPath,
+                                              readers,
+                                              static_cast<double>(sampleRate),
+                                              channels,
+                                              renderSamples,
+                                              result,
+                                              result.error);
+
+            if (rendered && result.stats.hasNaNOrInf)
+                result.error = "NaN/Inf detected in output";
+
+            result.passed = rendered && !result.stats.hasNaNOrInf;
+        },
+        [&](juce::AudioPluginInstance&, size_t jobIndex)
+        {
+            auto& result = results[jobIndex];
+            result.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - jobStarts[jobIndex]).count();
+
+            std::cout << (result.passed ? "PASS " : "FAIL ") << result.wetPath.getFileNameWithoutExtension();
+            for (size_t axis = 0; axis < axes.size(); ++axis)
+                std::cout << " " << axes[axis].parameterName << "=" << result.values[axis];
+            std::cout << " (" << result.wallSeconds << " s)";
+            if (!result.passed)
+                std::cout << ": " << result.error;
+            std::cout << "\n";
+        });
+
+    for (auto& instance : pool)
+    {
+        if (prepareErrors.find(instance.get()) == prepareErrors.end())
+            instance->releaseResources();
+    }
+
+    const double sweepSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - sweepStart).count();
+
+    juce::Array<juce::var> axisObjects;
+    for (const auto& axis : axes)
+    {
+        juce::Array<juce::var> values;
+        for (const float value : axis.values)
+            values.add(value);
+
+        juce::DynamicObject::Ptr axisObject = new juce::DynamicObject();
+        axisObject->setProperty("name", axis.parameterName);
+        axisObject->setProperty("index", axis.parameterIndex);
+        axisObject->setProperty("values", values);
+        axisObjects.add(juce::var(axisObject.get()));
+    }
+
+    juce::Array<juce::var> combinationObjects;
+    int numPassed = 0;
+    for (size_t combination = 0; combination < results.size(); ++combination)
+    {
+        if (results[combination].passed)
+            ++numPassed;
+        combinationObjects.add(makeSweepResultObject(results[combination], axes, combination, channels));
+    }
+
+    const int numFailed = static_cast<int>(results.size()) - numPassed;
+
+    juce::DynamicObject::Ptr indexObject = new juce::DynamicObject();
+    indexObject->setProperty("caseFile", casePath.getFullPathName());
+    indexObject->setProperty("plugin", pluginPath.getFullPathName());
+    indexObject->setProperty("input", inputPath.getFullPathName());
+    indexObject->setProperty("sampleRate", sampleRate);
+    indexObject->setProperty("blockSize", blockSize);
+    indexObject->setProperty("channels", channels);
+    indexObject->setProperty("workers", numWorkers);
+    indexObject->setProperty("wallSeconds", sweepSeconds);
+    indexObject->setProperty("numCombinations", static_cast<juce::int64>(results.size()));
+    indexObject->setProperty("passed", numPassed);
+    indexObject->setProperty("failed", numFailed);
+    indexObject->setProperty("axes", axisObjects);
+    indexObject->setProperty("combinations", combinationObjects);
+
+    const juce::File indexPath = outDir.getChildFile("sweep_index.json");
+    if (!writeJsonFile(indexPath, juce::var(indexObject.get()), error))
         return fail(error);
 
-    if (!configurePluginForChannels(*plugin, channels, static_cast<double>(sampleRate), blockSize, error))
+    std::cout << numPassed << "/" << results.size() << " combinations rendered in " << sweepSeconds
+              << " s on " << numWorkers << " workers\n"
+              << "Wrote: " << indexPath.getFullPathName() << "\n";
+
+    return numFailed == 0 ? 0 : 1;
+}
+
+// Exponential sweep defaults shared by generate and analyze --ir.
+constexpr double defaultSweepStartHz = 20.0;
+
+double defaultSweepEndHz(double sampleRate)
+{
+    return std::min(20000.0, 0.475 * sampleRate);
+}
+
+struct SweepResponse
+{
+    // Deconvolved wet signal, normalised so an identity plugin gives a unit
+    // impulse at zeroLagIndex; harmonic k appears harmonicOffset(k) earlier.
+    std::vector<float> response;
+    juce::int64 zeroLagIndex = 0;
+    double samplesPerLogFrequency = 0.0;
+
+    double harmonicPosition(int harmonic) const
+    {
+        return static_cast<double>(zeroLagIndex) - samplesPerLogFrequency * std::log(static_cast<double>(harmonic));
+    }
+};
+
+// Deconvolves wet with the inverse of the exponential sweep dry (Farina): the
+// time-reversed sweep, attenuated 6 dB per octave so the sweep's 1/f energy
+// comes out flat. Both convolutions are done with one FFT each, and the
+// result is scaled by the median in-band magnitude of dry convolved with the
+// inverse filter, so the sweep's level and fades cancel out.
+bool deconvolveSweep(const std::vector<float>& dry,
+                     const std::vector<float>& wet,
+                     double sampleRate,
+                     double startHz,
+                     double endHz,
+                     SweepResponse& result,
+                     juce::String& error)
+{
+    if (dry.empty())
+    {
+        error = "Dry sweep has no samples";
+        return false;
+    }
+
+    const auto sweepSamples = static_cast<juce::int64>(dry.size());
+    const double sweepSeconds = static_cast<double>(sweepSamples) / sampleRate;
+    const double sweepRate = std::log(endHz / startHz) / sweepSeconds;
+
+    int order = 1;
+    while ((juce::int64 { 1 } << order) < static_cast<juce::int64>(wet.size()) + sweepSamples)
+        ++order;
+
+    if (order > 27)
+    {
+        error = "Sweep and response are too long to deconvolve in one FFT";
+        return false;
+    }
+
+    juce::dsp::FFT fft(order);
+    const int fftSize = fft.getSize();
+
+    std::vector<float> inverse(static_cast<size_t>(2 * fftSize), 0.0f);
+    for (juce::int64 n = 0; n < sweepSamples; ++n)
+    {
+        const juce::int64 source = sweepSamples - 1 - n;
+        const double sourceSeconds = static_cast<double>(source) / sampleRate;
+        inverse[static_cast<size_t>(n)] = dry[static_cast<size_t>(source)] * static_cast<float>(std::exp(sweepRate * (sourceSeconds - sweepSeconds)));
+    }
+
+    std::vector<float> drySpectrum(static_cast<size_t>(2 * fftSize), 0.0f);
+    std::vector<float> wetSpectrum(static_cast<size_t>(2 * fftSize), 0.0f);
+    std::copy(dry.begin(), dry.end(), drySpectrum.begin());
+    std::copy(wet.begin(), wet.end(), wetSpectrum.begin());
+
+    fft.performRealOnlyForwardTransform(inverse.data(), true);
+    fft.performRealOnlyForwardTransform(drySpectrum.data(), true);
+    fft.performRealOnlyForwardTransform(wetSpectrum.data(), true);
+
+    const int numBins = fftSize / 2 + 1;
+    const double binHz = sampleRate / static_cast<double>(fftSize);
+    std::vector<float> referenceMagnitudes;
+
+    for (int bin = 0; bin < numBins; ++bin)
+    {
+        const std::complex<float> inverseBin(inverse[static_cast<size_t>(2 * bin)], inverse[static_cast<size_t>(2 * bin + 1)]);
+        const std::complex<float> dryBin(drySpectrum[static_cast<size_t>(2 * bin)], drySpectrum[static_cast<size_t>(2 * bin + 1)]);
+        const std::complex<float> wetBin(wetSpectrum[static_cast<size_t>(2 * bin)], wetSpectrum[static_cast<size_t>(2 * bin + 1)]);
+
+        // The band edges are shaped by the sweep's start and fade-out.
+        const double hz = binHz * bin;
+        if (hz >= 2.0 * startHz && hz <= 0.5 * endHz)
+            referenceMagnitudes.push_back(std::abs(dryBin * inverseBin));
+
+        const auto deconvolved = wetBin * inverseBin;
+        wetSpectrum[static_cast<size_t>(2 * bin)] = deconvolved.real();
+        wetSpectrum[static_cast<size_t>(2 * bin + 1)] = deconvolved.imag();
+    }
+
+    if (referenceMagnitudes.empty())
+    {
+        error = "Sweep band is too narrow to normalise the impulse response";
+        return false;
+    }
+
+    const auto median = referenceMagnitudes.begin() + static_cast<std::ptrdiff_t>(referenceMagnitudes.size() / 2);
+    std::nth_element(referenceMagnitudes.begin(), median, referenceMagnitudes.end());
+    const float normalisation = *median > 0.0f ? 1.0f / *median : 0.0f;
+
+    fft.performRealOnlyInverseTransform(wetSpectrum.data());
+
+    result.response.assign(wetSpectrum.begin(), wetSpectrum.begin() + fftSize);
+    for (auto& sample : result.response)
+        sample *= normalisation;
+
+    result.zeroLagIndex = sweepSamples - 1;
+    result.samplesPerLogFrequency = sampleRate / sweepRate;
+    return true;
+}
+
+// Cuts numSamples of the response starting preRoll samples before position,
+// with half-Hann tapers over the pre-roll and the last eighth.
+std::vector<float> extractImpulseResponse(const SweepResponse& sweepResponse, double position, int preRoll, int numSamples)
+{
+    std::vector<float> ir(static_cast<size_t>(numSamples), 0.0f);
+    const auto start = static_cast<juce::int64>(std::llround(position)) - preRoll;
+    const int fadeOut = std::max(1, numSamples / 8);
+    const auto responseSize = static_cast<juce::int64>(sweepResponse.response.size());
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const juce::int64 index = start + i;
+        if (index < 0 || index >= responseSize)
+            continue;
+
+        double gain = 1.0;
+        if (i < preRoll)
+            gain = 0.5 - 0.5 * std::cos(juce::MathConstants<double>::pi * i / preRoll);
+        else if (i >= numSamples - fadeOut)
+            gain = 0.5 + 0.5 * std::cos(juce::MathConstants<double>::pi * (i - (numSamples - fadeOut)) / fadeOut);
+
+        ir[static_cast<size_t>(i)] = static_cast<float>(gain * sweepResponse.response[static_cast<size_t>(index)]);
+    }
+
+    return ir;
+}
+
+// Frequency response of ir at hz, with time measured from sample `origin`.
+std::complex<double> evaluateResponse(const std::vector<float>& ir, double hz, double sampleRate, double origin)
+{
+    const double omega = juce::MathConstants<double>::twoPi * hz / sampleRate;
+    const std::complex<double> step(std::cos(omega), -std::sin(omega));
+    std::complex<double> rotation = std::polar(1.0, omega * origin);
+    std::complex<double> sum;
+
+    for (size_t i = 0; i < ir.size(); ++i)
+    {
+        sum += static_cast<double>(ir[i]) * rotation;
+        rotation *= step;
+
+        // Keep the recursive rotation on the unit circle.
+        if ((i & 1023) == 1023)
+            rotation /= std::abs(rotation);
+    }
+
+    return sum;
+}
+
+int runImpulseResponseAnalysis(const OptionMap& options,
+                               const AudioData& dryAudio,
+                               const AudioData& wetAudio,
+                               int channels,
+                               const juce::String& outDirText)
+{
+    juce::String error;
+    std::optional<double> startOption;
+    std::optional<double> endOption;
+    std::optional<int> harmonicsOption;
+    std::optional<int> irLengthOption;
+
+    if (!getOptionalDoubleOption(options, "f-start", startOption, error)
+        || !getOptionalDoubleOption(options, "f-end", endOption, error)
+        || !getOptionalIntOption(options, "harmonics", harmonicsOption, error)
+        || !getOptionalIntOption(options, "ir-length", irLengthOption, error))
+    {
         return fail(error);
+    }
+
+    const double sampleRate = dryAudio.sampleRate;
+    const double startHz = startOption.value_or(defaultSweepStartHz);
+    const double endHz = endOption.value_or(defaultSweepEndHz(sampleRate));
+    const int numHarmonics = harmonicsOption.value_or(5);
+    const int requestedLength = irLengthOption.value_or(8192);
 
-    plugin->setRateAndBufferSizeDetails(static_cast<double>(sampleRate), blockSize);
-    plugin->prepareToPlay(static_cast<double>(sampleRate), blockSize);
+    if (startHz <= 0.0 || endHz <= startHz || endHz > 0.5 * sampleRate)
+        return fail("Sweep needs 0 < --f-start < --f-end <= sr / 2");
+    if (numHarmonics < 1 || numHarmonics > 16)
+        return fail("--harmonics must be between 1 and 16");
+    if (requestedLength < 64)
+        return fail("--ir-length must be at least 64");
 
-    if (!applyParameterMapByIndex(*plugin, renderCase.paramsByIndex, error))
+    const juce::File outDir = resolvePath(outDirText);
+    if (!ensureDirectory(outDir, error))
         return fail(error);
 
-    if (!applyParameterMapByName(*plugin, renderCase.paramsByName, error))
+    SweepResponse sweepResponse;
+    if (!deconvolveSweep(makeMonoSum(dryAudio.buffer, channels), makeMonoSum(wetAudio.buffer, channels),
+                         sampleRate, startHz, endHz, sweepResponse, error))
+    {
         return fail(error);
+    }
 
-    plugin->reset();
+    // Each harmonic's window must end before the next lower harmonic begins.
+    const int preRoll = std::max(16, requestedLength / 16);
+    std::vector<std::vector<float>> irs;
 
-    const int processChannels = std::max({ channels, plugin->getTotalNumInputChannels(), plugin->getTotalNumOutputChannels(), 1 });
-    juce::AudioBuffer<float> ioBlock(processChannels, blockSize);
-    juce::MidiBuffer midi;
+    for (int harmonic = 1; harmonic <= numHarmonics; ++harmonic)
+    {
+        int length = requestedLength;
+        if (harmonic > 1)
+        {
+            const double spacing = sweepResponse.harmonicPosition(harmonic - 1) - sweepResponse.harmonicPosition(harmonic);
+            length = std::min(length, static_cast<int>(spacing) - preRoll);
+        }
 
-    const int warmupSamples = static_cast<int>(
-        std::round(static_cast<double>(sampleRate) * static_cast<double>(renderCase.warmupMs) / 1000.0));
+        if (length < 2 * preRoll || sweepResponse.harmonicPosition(harmonic) < preRoll)
+        {
+            std::cerr << "Warning: sweep too short to separate harmonic " << harmonic << " and above\n";
+            break;
+        }
 
-    for (int pos = 0; pos < warmupSamples; pos += blockSize)
+        irs.push_back(extractImpulseResponse(sweepResponse, sweepResponse.harmonicPosition(harmonic), preRoll, length));
+    }
+
+    if (irs.empty())
     {
-        ioBlock.clear();
-        plugin->processBlock(ioBlock, midi);
-        midi.clear();
+        return fail("Sweep too short for --ir-length " + juce::String(requestedLength) + ": it needs at least "
+                    + juce::String(preRoll) + " samples before the linear response");
     }
 
-    juce::AudioBuffer<float> wetBuffer(channels, renderSamples);
-    wetBuffer.clear();
+    const auto& linear = irs.front();
+    const auto peak = std::max_element(linear.begin(), linear.end(), [](float a, float b) { return std::abs(a) < std::abs(b); });
+    const int latencySamples = static_cast<int>(peak - linear.begin()) - preRoll;
+    const double linearOrigin = static_cast<double>(preRoll + latencySamples);
 
-    const int drySamples = dryBuffer.getNumSamples();
-    for (int pos = 0; pos < renderSamples; pos += blockSize)
+    auto toDb = [](double gain)
     {
-        const int thisBlock = std::min(blockSize, renderSamples - pos);
-        ioBlock.clear();
+        return gain > 0.0 ? 20.0 * std::log10(gain) : -400.0;
+    };
 
-        for (int channel = 0; channel < std::min(channels, ioBlock.getNumChannels()); ++channel)
+    juce::Array<juce::var> frequencyResponse;
+    juce::Array<juce::var> thdPoints;
+    std::vector<juce::Array<juce::var>> harmonicLevels(irs.size());
+
+    // Twelve points per octave across the sweep.
+    for (double hz = startHz; hz <= endHz * 1.0001; hz *= std::pow(2.0, 1.0 / 12.0))
+    {
+        const auto fundamental = evaluateResponse(linear, hz, sampleRate, linearOrigin);
+        const double fundamentalMagnitude = std::abs(fundamental);
+
+        juce::DynamicObject::Ptr point = new juce::DynamicObject();
+        point->setProperty("hz", hz);
+        point->setProperty("magnitudeDb", toDb(fundamentalMagnitude));
+        point->setProperty("phaseDeg", juce::radiansToDegrees(std::arg(fundamental)));
+        frequencyResponse.add(juce::var(point.get()));
+
+        double distortionPower = 0.0;
+        bool hasHarmonics = false;
+
+        for (size_t index = 1; index < irs.size(); ++index)
         {
-            const int remainingDry = std::max(0, drySamples - pos);
-            const int copyCount = std::min(thisBlock, remainingDry);
-            if (copyCount > 0)
-            {
-                ioBlock.copyFrom(channel, 0, dryBuffer, channel, pos, copyCount);
-            }
-        }
+            const double harmonicHz = hz * static_cast<double>(index + 1);
+            if (harmonicHz > endHz)
+                break;
 
-        plugin->processBlock(ioBlock, midi);
-        midi.clear();
+            // The harmonic IRs sit at fractional positions, so only their
+            // magnitude is meaningful.
+            const double magnitude = std::abs(evaluateResponse(irs[index], harmonicHz, sampleRate, preRoll));
+            distortionPower += magnitude * magnitude;
+            hasHarmonics = true;
 
-        for (int channel = 0; channel < channels; ++channel)
+            juce::DynamicObject::Ptr level = new juce::DynamicObject();
+            level->setProperty("hz", hz);
+            level->setProperty("levelDbc", toDb(fundamentalMagnitude > 0.0 ? magnitude / fundamentalMagnitude : 0.0));
+            harmonicLevels[index].add(juce::var(level.get()));
+        }
+
+        if (hasHarmonics && fundamentalMagnitude > 0.0)
         {
-            if (channel < ioBlock.getNumChannels())
-                wetBuffer.copyFrom(channel, pos, ioBlock, channel, 0, thisBlock);
+            const double thd = std::sqrt(distortionPower) / fundamentalMagnitude;
+            juce::DynamicObject::Ptr thdPoint = new juce::DynamicObject();
+            thdPoint->setProperty("hz", hz);
+            thdPoint->setProperty("percent", 100.0 * thd);
+            thdPoint->setProperty("db", toDb(thd));
+            thdPoints.add(juce::var(thdPoint.get()));
         }
     }
 
-    plugin->releaseResources();
-
-    if (!ensureDirectory(outDir, error))
-        return fail(error);
+    juce::Array<juce::var> harmonicsArray;
+    for (size_t index = 1; index < irs.size(); ++index)
+    {
+        juce::DynamicObject::Ptr harmonicObject = new juce::DynamicObject();
+        harmonicObject->setProperty("harmonic", static_cast<int>(index + 1));
+        harmonicObject->setProperty("irLength", static_cast<int>(irs[index].size()));
+        harmonicObject->setProperty("levels", harmonicLevels[index]);
+        harmonicsArray.add(juce::var(harmonicObject.get()));
+    }
 
-    const juce::File wetPath = outDir.getChildFile("wet.wav");
-    if (!writeWavFile(wetPath, wetBuffer, static_cast<double>(sampleRate), error))
+    juce::DynamicObject::Ptr sweepObject = new juce::DynamicObject();
+    sweepObject->setProperty("startHz", startHz);
+    sweepObject->setProperty("endHz", endHz);
+    sweepObject->setProperty("seconds", static_cast<double>(dryAudio.buffer.getNumSamples()) / sampleRate);
+
+    juce::DynamicObject::Ptr irObject = new juce::DynamicObject();
+    irObject->setProperty("sampleRate", sampleRate);
+    irObject->setProperty("sweep", juce::var(sweepObject.get()));
+    irObject->setProperty("irLength", static_cast<int>(linear.size()));
+    irObject->setProperty("preRollSamples", preRoll);
+    irObject->setProperty("latencySamples", latencySamples);
+    irObject->setProperty("frequencyResponse", frequencyResponse);
+    irObject->setProperty("harmonics", harmonicsArray);
+    irObject->setProperty("thd", thdPoints);
+
+    // One channel per IR: the linear response first, then each harmonic.
+    juce::AudioBuffer<float> irBuffer(static_cast<int>(irs.size()), static_cast<int>(linear.size()));
+    irBuffer.clear();
+    for (size_t index = 0; index < irs.size(); ++index)
+        irBuffer.copyFrom(static_cast<int>(index), 0, irs[index].data(), static_cast<int>(irs[index].size()));
+
+    const juce::File irPath = outDir.getChildFile("ir.wav");
+    auto writer = createWavWriter(irPath, sampleRate, irBuffer.getNumChannels(), error, 32);
+    if (writer == nullptr || !writer->writeFromAudioSampleBuffer(irBuffer, 0, irBuffer.getNumSamples()))
+        return fail(error.isNotEmpty() ? error : "Failed while writing " + irPath.getFullPathName());
+
+    writer.reset();
+
+    const juce::File irJsonPath = outDir.getChildFile("ir.json");
+    if (!writeJsonFile(irJsonPath, juce::var(irObject.get()), error))
         return fail(error);
 
-    std::cout << "Wrote: " << wetPath.getFullPathName() << "\n";
+    std::cout << "Latency: " << latencySamples << " samples, " << irs.size() - 1 << " harmonics separated\n"
+              << "Wrote: " << irPath.getFullPathName() << "\n"
+              << "Wrote: " << irJsonPath.getFullPathName() << "\n";
     return 0;
 }
 
@@ -978,6 +4558,14 @@ int runAnalyze(const OptionMap& options)
     const bool autoAlign = getFlag(options, "auto-align");
     const bool doNull = getFlag(options, "null");
 
+    std::optional<int> maxLagOption;
+    if (!getOptionalIntOption(options, "max-lag", maxLagOption, error))
+        return fail(error);
+
+    const int maxLagSamples = maxLagOption.value_or(4096);
+    if (maxLagSamples < 0)
+        return fail("--max-lag must be non-negative");
+
     AudioData dryAudio;
     AudioData wetAudio;
 
@@ -997,53 +4585,53 @@ int runAnalyze(const OptionMap& options)
     if (channels <= 0)
         return fail("Dry/wet audio must each contain at least one channel");
 
+    if (getFlag(options, "ir"))
+        return runImpulseResponseAnalysis(options, dryAudio, wetAudio, channels, outDirText);
+
     int detectedLatencySamples = 0;
     if (autoAlign)
     {
-        const auto dryMono = makeMonoSum(copyChannels(dryAudio.buffer, channels));
-        const auto wetMono = makeMonoSum(copyChannels(wetAudio.buffer, channels));
-        detectedLatencySamples = detectLatencyByCrossCorrelation(dryMono, wetMono, 4096);
+        const auto dryMono = makeMonoSum(dryAudio.buffer, channels);
+        const auto wetMono = makeMonoSum(wetAudio.buffer, channels);
+        detectedLatencySamples = detectLatencyByCrossCorrelation(dryMono, wetMono, maxLagSamples);
     }
 
-    const int targetSamples = std::max(dryAudio.buffer.getNumSamples(), wetAudio.buffer.getNumSamples())
-                            + std::abs(detectedLatencySamples);
-
-    const auto dryAligned = shiftAndResize(dryAudio.buffer, channels, targetSamples, 0);
-    const auto wetAligned = shiftAndResize(wetAudio.buffer, channels, targetSamples, -detectedLatencySamples);
-    const auto wetMetrics = computeLevels(wetAligned);
-    const double correlation = computeCorrelation(dryAligned, wetAligned);
-    const bool hasNaNOrInfWet = containsNaNOrInf(wetAligned);
-
-    bool hasNaNOrInfDelta = false;
-    LevelMetrics deltaMetrics;
-    juce::AudioBuffer<float> delta;
-
-    if (doNull)
-    {
-        delta.makeCopyOf(wetAligned);
-        for (int channel = 0; channel < delta.getNumChannels(); ++channel)
-            delta.addFrom(channel, 0, dryAligned, channel, 0, delta.getNumSamples(), -1.0f);
-
-        deltaMetrics = computeLevels(delta);
-        hasNaNOrInfDelta = containsNaNOrInf(delta);
-    }
+    const juce::int64 targetSamples = static_cast<juce::int64>(std::max(dryAudio.buffer.getNumSamples(), wetAudio.buffer.getNumSamples()))
+                                    + std::abs(detectedLatencySamples);
 
     const juce::File outDir = resolvePath(outDirText);
     if (!ensureDirectory(outDir, error))
         return fail(error);
 
+    std::unique_ptr<juce::AudioFormatWriter> deltaWriter;
     if (doNull)
     {
-        const juce::File deltaPath = outDir.getChildFile("delta.wav");
-        if (!writeWavFile(deltaPath, delta, dryAudio.sampleRate, error))
+        deltaWriter = createWavWriter(outDir.getChildFile("delta.wav"), dryAudio.sampleRate, channels, error);
+        if (deltaWriter == nullptr)
             return fail(error);
     }
 
+    AnalyzeSums sums;
+    if (!runFusedAnalyzePass(dryAudio.buffer, wetAudio.buffer, channels, targetSamples, detectedLatencySamples, deltaWriter.get(), sums, error))
+        return fail(error);
+
+    deltaWriter.reset();
+
+    const auto wetMetrics = levelsFromStats(sums.wet, channels);
+    const auto deltaMetrics = levelsFromStats(sums.delta, channels);
+    const double correlation = correlationFromSums(sums);
+    const bool hasNaNOrInfWet = sums.wet.hasNaNOrInf;
+    const bool hasNaNOrInfDelta = sums.delta.hasNaNOrInf;
+
     juce::DynamicObject::Ptr metricsObject = new juce::DynamicObject();
     metricsObject->setProperty("sampleRate", dryAudio.sampleRate);
     metricsObject->setProperty("channels", channels);
     metricsObject->setProperty("numSamples", targetSamples);
     metricsObject->setProperty("detectedLatencySamples", detectedLatencySamples);
+
+    if (autoAlign)
+        metricsObject->setProperty("maxLagSamples", maxLagSamples);
+
     metricsObject->setProperty("wetPeakDbfs", wetMetrics.peakDbfs);
     metricsObject->setProperty("wetRmsDbfs", wetMetrics.rmsDbfs);
     metricsObject->setProperty("correlation", correlation);
@@ -1057,12 +4645,8 @@ int runAnalyze(const OptionMap& options)
     }
 
     const juce::File metricsPath = outDir.getChildFile("metrics.json");
-    const auto metricsJson = juce::JSON::toString(
-        juce::var(metricsObject.get()),
-        juce::JSON::FormatOptions().withSpacing(juce::JSON::Spacing::multiLine).withEncoding(juce::JSON::Encoding::ascii));
-
-    if (!metricsPath.replaceWithText(metricsJson))
-        return fail("Failed to write metrics JSON: " + metricsPath.getFullPathName());
+    if (!writeJsonFile(metricsPath, juce::var(metricsObject.get()), error))
+        return fail(error);
 
     if (hasNaNOrInfWet || hasNaNOrInfDelta)
     {
@@ -1074,10 +4658,509 @@ int runAnalyze(const OptionMap& options)
     return 0;
 }
 
+enum class SignalType
+{
+    impulse,
+    sine,
+    sweep,
+    whiteNoise,
+    pinkNoise,
+    multitone
+};
+
+struct SignalSpec
+{
+    SignalType type = SignalType::sine;
+    double sampleRate = 48000.0;
+    juce::int64 numSamples = 0;
+    double amplitude = 0.5;
+    std::vector<double> frequencies;
+    double sweepStartHz = 20.0;
+    double sweepEndHz = 20000.0;
+    juce::uint32 seed = 1;
+};
+
+constexpr int generatorLanes = 8;
+constexpr int generateChunkSamples = 8192;
+
+// Adds amplitude * sin(2 pi frequency n / sampleRate) for the numSamples samples
+// starting at absolute index start. Eight phasors one sample apart rotate
+// together, so the inner loops carry no dependency between lanes and
+// vectorise. The start phase is recomputed from the absolute index on every
+// call, so rounding never accumulates over long files.
+void addSine(float* dest, int numSamples, juce::int64 start, double frequency, double sampleRate, double amplitude)
+{
+    constexpr double twoPi = juce::MathConstants<double>::twoPi;
+    const double cyclesPerSample = frequency / sampleRate;
+    const double startCycles = std::fmod(static_cast<double>(start) * cyclesPerSample, 1.0);
+
+    double re[generatorLanes];
+    double im[generatorLanes];
+    for (int lane = 0; lane < generatorLanes; ++lane)
+    {
+        const double angle = twoPi * (startCycles + cyclesPerSample * lane);
+        re[lane] = amplitude * std::cos(angle);
+        im[lane] = amplitude * std::sin(angle);
+    }
+
+    const double stepAngle = twoPi * cyclesPerSample * generatorLanes;
+    const double stepRe = std::cos(stepAngle);
+    const double stepIm = std::sin(stepAngle);
+
+    int i = 0;
+    for (; i + generatorLanes <= numSamples; i += generatorLanes)
+    {
+        for (int lane = 0; lane < generatorLanes; ++lane)
+            dest[i + lane] += static_cast<float>(im[lane]);
+
+        for (int lane = 0; lane < generatorLanes; ++lane)
+        {
+            const double rotatedRe = re[lane] * stepRe - im[lane] * stepIm;
+            im[lane] = re[lane] * stepIm + im[lane] * stepRe;
+            re[lane] = rotatedRe;
+        }
+    }
+
+    for (int lane = 0; i < numSamples; ++i, ++lane)
+        dest[i] += static_cast<float>(im[lane]);
+}
+
+// Uniform noise in [-amplitude, amplitude) from eight independent xorshift32
+// generators, one per lane.
+struct NoiseState
+{
+    juce::uint32 lanes[generatorLanes] {};
+
+    void seed(juce::uint32 seed)
+    {
+        // splitmix-style scrambling keeps nearby seeds uncorrelated and never yields 0.
+        for (int lane = 0; lane < generatorLanes; ++lane)
+        {
+            juce::uint32 z = seed * 0x9e3779b9u + static_cast<juce::uint32>(lane + 1) * 0x85ebca6bu;
+            z = (z ^ (z >> 16)) * 0x7feb352du;
+            z = (z ^ (z >> 15)) * 0x846ca68bu;
+            lanes[lane] = (z ^ (z >> 16)) | 1u;
+        }
+    }
+};
+
+void fillWhiteNoise(float* dest, int numSamples, NoiseState& state, float amplitude)
+{
+    const float scale = amplitude / 2147483648.0f;
+    juce::uint32 x[generatorLanes];
+    std::copy(std::begin(state.lanes), std::end(state.lanes), x);
+
+    int i = 0;
+    for (; i + generatorLanes <= numSamples; i += generatorLanes)
+    {
+        for (int lane = 0; lane < generatorLanes; ++lane)
+        {
+            x[lane] ^= x[lane] << 13;
+            x[lane] ^= x[lane] >> 17;
+            x[lane] ^= x[lane] << 5;
+            dest[i + lane] = static_cast<float>(static_cast<juce::int32>(x[lane])) * scale;
+        }
+    }
+
+    for (int lane = 0; i < numSamples; ++i, ++lane)
+    {
+        x[lane] ^= x[lane] << 13;
+        x[lane] ^= x[lane] >> 17;
+        x[lane] ^= x[lane] << 5;
+        dest[i] = static_cast<float>(static_cast<juce::int32>(x[lane])) * scale;
+    }
+
+    std::copy(std::begin(x), std::end(x), std::begin(state.lanes));
+}
+
+// Paul Kellet's refined pink noise filter (within 0.05 dB of -3 dB/octave
+// above 10 Hz at 44.1 kHz).
+struct PinkFilter
+{
+    double b[7] {};
+
+    double process(double white) noexcept
+    {
+        b[0] = 0.99886 * b[0] + white * 0.0555179;
+        b[1] = 0.99332 * b[1] + white * 0.0750759;
+        b[2] = 0.96900 * b[2] + white * 0.1538520;
+        b[3] = 0.86650 * b[3] + white * 0.3104856;
+        b[4] = 0.55000 * b[4] + white * 0.5329522;
+        b[5] = -0.7616 * b[5] - white * 0.0168980;
+        const double pink = b[0] + b[1] + b[2] + b[3] + b[4] + b[5] + b[6] + white * 0.5362;
+        b[6] = white * 0.115926;
+        return pink;
+    }
+};
+
+// Gain that gives the pink filter the same output power as its white input,
+// from the energy of its impulse response.
+double pinkNormalisationGain()
+{
+    PinkFilter filter;
+    double energy = 0.0;
+
+    for (int i = 0; i < 1 << 16; ++i)
+    {
+        const double response = filter.process(i == 0 ? 1.0 : 0.0);
+        energy += response * response;
+    }
+
+    return 1.0 / std::sqrt(energy);
+}
+
+// Exponential sine sweep (Farina): the instantaneous frequency rises from
+// startHz to endHz exponentially over the whole file. The last 10 ms are
+// faded out so the file does not end on a step.
+void fillSweep(float* dest, int numSamples, juce::int64 start, const SignalSpec& spec)
+{
+    constexpr double twoPi = juce::MathConstants<double>::twoPi;
+    const double duration = static_cast<double>(spec.numSamples) / spec.sampleRate;
+    const double rate = std::log(spec.sweepEndHz / spec.sweepStartHz) / duration;
+    const double phaseScale = twoPi * spec.sweepStartHz / rate;
+    const juce::int64 fadeSamples = std::max<juce::int64>(1, std::llround(0.01 * spec.sampleRate));
+    const juce::int64 fadeStart = spec.numSamples - fadeSamples;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const juce::int64 n = start + i;
+        const double t = static_cast<double>(n) / spec.sampleRate;
+        double value = spec.amplitude * std::sin(phaseScale * std::expm1(rate * t));
+
+        if (n >= fadeStart)
+            value *= 0.5 * (1.0 + std::cos(juce::MathConstants<double>::pi * static_cast<double>(n - fadeStart) / static_cast<double>(fadeSamples)));
+
+        dest[i] = static_cast<float>(value);
+    }
+}
+
+bool parseSignalType(const juce::String& text, SignalType& outType)
+{
+    const std::pair<const char*, SignalType> names[] = {
+        { "impulse", SignalType::impulse },
+        { "sine", SignalType::sine },
+        { "sweep", SignalType::sweep },
+        { "white", SignalType::whiteNoise },
+        { "pink", SignalType::pinkNoise },
+        { "multitone", SignalType::multitone },
+    };
+
+    for (const auto& [name, type] : names)
+    {
+        if (text == name)
+        {
+            outType = type;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool parseFrequencyList(const juce::String& text, std::vector<double>& outFrequencies, juce::String& error)
+{
+    outFrequencies.clear();
+
+    for (const auto& token : juce::StringArray::fromTokens(text, ",", ""))
+    {
+        double frequency = 0.0;
+        if (!parseDoubleStrict(token.trim().toStdString(), frequency) || frequency <= 0.0)
+        {
+            error = "Invalid frequency in --freqs: " + token;
+            return false;
+        }
+
+        outFrequencies.push_back(frequency);
+    }
+
+    if (outFrequencies.empty())
+    {
+        error = "--freqs needs at least one frequency";
+        return false;
+    }
+
+    return true;
+}
+
+int runGenerate(const OptionMap& options)
+{
+    juce::String typeText;
+    juce::String outPathText;
+    juce::String error;
+    int sampleRate = 0;
+    juce::AudioChannelSet channelLayout;
+    std::optional<double> secondsOption;
+    std::optional<double> levelOption;
+    std::optional<double> frequencyOption;
+    std::optional<double> startFrequencyOption;
+    std::optional<double> endFrequencyOption;
+    std::optional<int> seedOption;
+
+    if (!getRequiredOption(options, "type", typeText, error)
+        || !getRequiredOption(options, "out", outPathText, error)
+        || !getRequiredIntOption(options, "sr", sampleRate, error)
+        || !getRequiredChannelLayoutOption(options, "ch", channelLayout, error)
+        || !getOptionalDoubleOption(options, "seconds", secondsOption, error)
+        || !getOptionalDoubleOption(options, "level", levelOption, error)
+        || !getOptionalDoubleOption(options, "freq", frequencyOption, error)
+        || !getOptionalDoubleOption(options, "f-start", startFrequencyOption, error)
+        || !getOptionalDoubleOption(options, "f-end", endFrequencyOption, error)
+        || !getOptionalIntOption(options, "seed", seedOption, error))
+    {
+        return fail(error);
+    }
+
+    const double seconds = secondsOption.value_or(2.0);
+    if (sampleRate <= 0 || seconds <= 0.0)
+        return fail("sr and seconds must be positive");
+
+    SignalSpec spec;
+    if (!parseSignalType(typeText, spec.type))
+        return fail("Unknown --type: " + typeText + " (use impulse, sine, sweep, white, pink or multitone)");
+
+    spec.sampleRate = static_cast<double>(sampleRate);
+    spec.numSamples = static_cast<juce::int64>(std::llround(seconds * spec.sampleRate));
+    spec.amplitude = juce::Decibels::decibelsToGain(levelOption.value_or(spec.type == SignalType::impulse ? -1.0 : -6.0), -400.0);
+    spec.seed = static_cast<juce::uint32>(seedOption.value_or(1));
+
+    const double nyquist = 0.5 * spec.sampleRate;
+
+    if (spec.type == SignalType::sine)
+    {
+        spec.frequencies = { frequencyOption.value_or(1000.0) };
+    }
+    else if (spec.type == SignalType::multitone)
+    {
+        juce::String frequenciesText = "100,1000,5000";
+        getOptionalOption(options, "freqs", frequenciesText);
+        if (!parseFrequencyList(frequenciesText, spec.frequencies, error))
+            return fail(error);
+    }
+    else if (spec.type == SignalType::sweep)
+    {
+        spec.sweepStartHz = startFrequencyOption.value_or(defaultSweepStartHz);
+        spec.sweepEndHz = endFrequencyOption.value_or(defaultSweepEndHz(spec.sampleRate));
+        if (spec.sweepStartHz <= 0.0 || spec.sweepEndHz <= spec.sweepStartHz || spec.sweepEndHz > nyquist)
+            return fail("Sweep needs 0 < --f-start < --f-end <= sr / 2");
+    }
+
+    for (const double frequency : spec.frequencies)
+    {
+        if (frequency <= 0.0 || frequency >= nyquist)
+            return fail("Frequencies must be between 0 and sr / 2: " + juce::String(frequency));
+    }
+
+    const int channels = channelLayout.size();
+    const juce::File outPath = resolvePath(outPathText);
+    if (!ensureDirectory(outPath.getParentDirectory(), error))
+        return fail(error);
+
+    auto writer = createWavWriter(outPath, spec.sampleRate, channels, error);
+    if (writer == nullptr)
+        return fail(error);
+
+    // Noise is independent per channel; every other signal is generated once
+    // per chunk and copied to the remaining channels.
+    const bool isNoise = spec.type == SignalType::whiteNoise || spec.type == SignalType::pinkNoise;
+    std::vector<NoiseState> noiseStates(static_cast<size_t>(channels));
+    std::vector<PinkFilter> pinkFilters(static_cast<size_t>(channels));
+    for (int channel = 0; channel < channels; ++channel)
+        noiseStates[static_cast<size_t>(channel)].seed(spec.seed + static_cast<juce::uint32>(channel) * 0x51ed27u);
+
+    // Pink noise gets the same RMS as white noise at the same level.
+    const double pinkGain = spec.type == SignalType::pinkNoise ? pinkNormalisationGain() : 1.0;
+    const double toneAmplitude = spec.frequencies.empty() ? 0.0 : spec.amplitude / static_cast<double>(spec.frequencies.size());
+
+    juce::AudioBuffer<float> chunk(channels, generateChunkSamples);
+    const auto startTime = std::chrono::steady_clock::now();
+
+    for (juce::int64 pos = 0; pos < spec.numSamples; pos += generateChunkSamples)
+    {
+        const int thisChunk = static_cast<int>(std::min<juce::int64>(generateChunkSamples, spec.numSamples - pos));
+        chunk.clear();
+
+        if (isNoise)
+        {
+            for (int channel = 0; channel < channels; ++channel)
+            {
+                float* samples = chunk.getWritePointer(channel);
+                fillWhiteNoise(samples, thisChunk, noiseStates[static_cast<size_t>(channel)], static_cast<float>(spec.amplitude));
+
+                if (spec.type == SignalType::pinkNoise)
+                {
+                    auto& filter = pinkFilters[static_cast<size_t>(channel)];
+                    for (int i = 0; i < thisChunk; ++i)
+                        samples[i] = static_cast<float>(juce::jlimit(-1.0, 1.0, pinkGain * filter.process(samples[i])));
+                }
+            }
+        }
+        else
+        {
+            float* samples = chunk.getWritePointer(0);
+
+            if (spec.type == SignalType::impulse)
+            {
+                if (pos == 0)
+                    samples[0] = static_cast<float>(spec.amplitude);
+            }
+            else if (spec.type == SignalType::sweep)
+            {
+                fillSweep(samples, thisChunk, pos, spec);
+            }
+            else
+            {
+                for (const double frequency : spec.frequencies)
+                    addSine(samples, thisChunk, pos, frequency, spec.sampleRate, toneAmplitude);
+            }
+
+            for (int channel = 1; channel < channels; ++channel)
+                chunk.copyFrom(channel, 0, chunk, 0, 0, thisChunk);
+        }
+
+        if (!writer->writeFromAudioSampleBuffer(chunk, 0, thisChunk))
+            return fail("Failed while writing WAV data at sample " + juce::String(pos));
+    }
+
+    writer.reset();
+
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    std::cout << "Generated " << seconds << " s of " << typeText << " (" << channels << " ch) in " << elapsed << " s\n"
+              << "Wrote: " << outPath.getFullPathName() << "\n";
+    return 0;
+}
+
+// Processes interleaved little-endian float32 from stdin to stdout, one fixed
+// size block at a time, so the harness can sit in a pipe. Every buffer is
+// allocated before the first block. Output has exactly as many frames as the
+// input; diagnostics go to stderr.
+int runStream(const OptionMap& options)
+{
+    juce::String pluginPathText;
+    juce::String casePathText;
+    juce::String error;
+    int sampleRate = 0;
+    int blockSize = 0;
+    juce::AudioChannelSet channelLayout;
+
+    if (!getRequiredOption(options, "plugin", pluginPathText, error)
+        || !getRequiredIntOption(options, "sr", sampleRate, error)
+        || !getRequiredIntOption(options, "bs", blockSize, error)
+        || !getRequiredChannelLayoutOption(options, "ch", channelLayout, error))
+    {
+        return fail(error);
+    }
+
+    if (sampleRate <= 0 || blockSize <= 0)
+        return fail("sr and bs must be positive");
+
+    const int channels = channelLayout.size();
+
+    RenderCase renderCase;
+    if (getOptionalOption(options, "case", casePathText))
+    {
+        if (!parseRenderCaseFile(resolvePath(casePathText), renderCase, error))
+            return fail(error);
+    }
+
+    // Anything the plugin or JUCE prints to stdout would end up in the audio,
+    // so the audio gets a descriptor of its own and stdout goes to stderr.
+    std::FILE* audioOut = stdout;
+   #if JUCE_WINDOWS
+    _setmode(_fileno(stdin), _O_BINARY);
+    _setmode(_fileno(stdout), _O_BINARY);
+   #else
+    std::fflush(stdout);
+    const int audioDescriptor = dup(STDOUT_FILENO);
+    if (audioDescriptor < 0 || dup2(STDERR_FILENO, STDOUT_FILENO) < 0
+        || (audioOut = fdopen(audioDescriptor, "wb")) == nullptr)
+    {
+        return fail("Failed to separate the audio output from stdout");
+    }
+   #endif
+
+    auto plugin = createPreparedPlugin(resolvePath(pluginPathText),
+                                       getPluginCacheOptions(options),
+                                       renderCase,
+                                       static_cast<double>(sampleRate),
+                                       blockSize,
+                                       channelLayout,
+                                       juce::AudioProcessor::singlePrecision,
+                                       error);
+    if (plugin == nullptr)
+        return fail(error);
+
+    Automation automation;
+    if (!buildAutomation(*plugin, renderCase, static_cast<double>(sampleRate), automation, error))
+        return fail(error);
+
+    applyAutomationAt(automation, 0);
+
+    juce::AudioBuffer<float> ioBlock(getProcessChannelCount(*plugin, channels), blockSize);
+    juce::MidiBuffer midi;
+    runWarmup(*plugin, ioBlock, midi, static_cast<double>(sampleRate), renderCase.warmupMs);
+
+    const size_t frameBytes = sizeof(float) * static_cast<size_t>(channels);
+    std::vector<float> interleaved(static_cast<size_t>(channels) * static_cast<size_t>(blockSize));
+    RenderStats stats;
+    juce::int64 pos = 0;
+
+    for (;;)
+    {
+        // fread only comes up short at the end of the input (or on an error).
+        const size_t bytesRead = std::fread(interleaved.data(), 1, frameBytes * static_cast<size_t>(blockSize), stdin);
+        const int thisBlock = static_cast<int>(bytesRead / frameBytes);
+
+        if (bytesRead % frameBytes != 0)
+            std::cerr << "Warning: input ended part way through a frame; the partial frame was dropped\n";
+
+        if (thisBlock > 0)
+        {
+            ioBlock.clear();
+            deinterleaveFloat32(interleaved.data(), channels, thisBlock, ioBlock.getArrayOfWritePointers());
+
+            processHostBlock(*plugin, ioBlock, thisBlock, pos, automation, midi, RtCheck {});
+            accumulateRenderStats(ioBlock, channels, thisBlock, stats);
+
+            interleaveFloat32(ioBlock.getArrayOfReadPointers(), channels, thisBlock, interleaved.data());
+            if (std::fwrite(interleaved.data(), frameBytes, static_cast<size_t>(thisBlock), audioOut) != static_cast<size_t>(thisBlock))
+                return fail("Failed while writing to stdout at sample " + juce::String(pos));
+
+            pos += thisBlock;
+        }
+
+        if (thisBlock < blockSize)
+            break;
+    }
+
+    if (std::ferror(stdin))
+        return fail("Failed while reading from stdin at sample " + juce::String(pos));
+
+    plugin->releaseResources();
+
+    if (std::fflush(audioOut) != 0)
+        return fail("Failed while writing to stdout");
+
+    const auto levels = levelsFromStats(stats, channels);
+    std::cerr << "Streamed " << pos << " samples (" << static_cast<double>(pos) / sampleRate << " s), wet peak "
+              << levels.peakDbfs << " dBFS\n";
+
+    if (stats.hasNaNOrInf)
+    {
+        std::cerr << "Error: NaN/Inf detected in output buffers\n";
+        return 2;
+    }
+
+    return 0;
+}
+
 } // namespace
 
 int main(int argc, char* argv[])
 {
+   #if JUCE_LINUX
+    relaunchWithRtCheckShimIfNeeded(argc, argv);
+   #endif
+
     juce::ScopedJuceInitialiser_GUI juceInit;
 
     if (argc <= 1)
@@ -1109,8 +5192,20 @@ int main(int argc, char* argv[])
         return runDumpParams(options);
     if (firstArg == "render")
         return runRender(options);
+    if (firstArg == "run-suite")
+        return runSuite(options);
+    if (firstArg == "sweep")
+        return runSweep(options);
+    if (firstArg == "bench")
+        return runBench(options);
+    if (firstArg == "state-bench")
+        return runStateBench(options);
     if (firstArg == "analyze")
         return runAnalyze(options);
+    if (firstArg == "generate")
+        return runGenerate(options);
+    if (firstArg == "stream")
+        return runStream(options);
 
     return fail("Unknown subcommand: " + firstArg);
 }
@@ -0,0 +1,70 @@
+#pragma once
+
+// Interface between vst3_harness and the realtime-safety shim
+// (libvst3_harness_rtcheck.so), which is injected with LD_PRELOAD. The harness
+// looks these functions up at runtime, so it also works without the shim.
+
+#include <cstdint>
+
+constexpr int rtCheckMaxFrames = 32;
+constexpr int rtCheckMaxSites = 1024;
+
+enum RtCheckKind : int
+{
+    rtCheckMalloc = 0,
+    rtCheckCalloc,
+    rtCheckRealloc,
+    rtCheckAlignedAlloc,
+    rtCheckFree,
+    rtCheckOperatorNew,
+    rtCheckOperatorDelete,
+    rtCheckMutexLock,
+    rtCheckNumKinds
+};
+
+inline const char* getRtCheckKindName(int kind)
+{
+    switch (kind)
+    {
+        case rtCheckMalloc:         return "malloc";
+        case rtCheckCalloc:         return "calloc";
+        case rtCheckRealloc:        return "realloc";
+        case rtCheckAlignedAlloc:   return "aligned_alloc";
+        case rtCheckFree:           return "free";
+        case rtCheckOperatorNew:    return "operator new";
+        case rtCheckOperatorDelete: return "operator delete";
+        case rtCheckMutexLock:      return "pthread_mutex_lock";
+        default:                    return "unknown";
+    }
+}
+
+// One distinct violation site: the same kind of call from the same call stack.
+// For mutex locks, contendedCount is how many of the calls found the mutex
+// already held and outermostCount how many were the outermost lock of their
+// block (see rt_check_shim.cpp).
+struct RtCheckSite
+{
+    int kind;
+    int numFrames;
+    std::int64_t count;
+    std::int64_t contendedCount;
+    std::int64_t outermostCount;
+    std::int64_t firstBlock;
+    std::int64_t lastBlock;
+    void* frames[rtCheckMaxFrames];
+};
+
+extern "C"
+{
+// Marks the calling thread as being inside processBlock for the given block.
+using RtCheckBeginFn = void (*)(std::int64_t blockIndex);
+// Ends the processBlock region started by the matching begin call.
+using RtCheckEndFn = void (*)();
+// Copies up to maxSites recorded sites into sites and returns how many were
+// copied. totalViolations and droppedSites may be null.
+using RtCheckGetSitesFn = int (*)(RtCheckSite* sites, int maxSites, std::int64_t* totalViolations, std::int64_t* droppedSites);
+}
+
+#define VST3_HARNESS_RTCHECK_BEGIN "vst3_harness_rtcheck_begin"
+#define VST3_HARNESS_RTCHECK_END "vst3_harness_rtcheck_end"
+#define VST3_HARNESS_RTCHECK_GET_SITES "vst3_harness_rtcheck_get_sites"
@@ -0,0 +1,358 @@
+// Realtime-safety shim for vst3_harness --rt-check (Linux only).
+//
+// Loaded into the harness with LD_PRELOAD, it interposes the allocator entry
+// points, the global operator new/delete family and pthread_mutex_lock. Calls
+// made on a thread while the harness has it marked as being inside
+// processBlock are recorded as violations, grouped by kind and call stack.
+// Every mutex lock is recorded; whether the mutex was already held is kept
+// alongside as the site's contended count.
+//
+// The plugin wrapper's callback lock is recorded like any other lock, but the
+// shim also notes when a lock was the outermost one of its block: the first
+// lock taken, with no other lock following its release. The harness reports
+// sites where that held every time separately from the violations.
+//
+// Everything here runs inside malloc, so the bookkeeping uses only static
+// storage, thread-locals with static TLS, and a spin lock.
+
+#include "rt_check.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <new>
+
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <pthread.h>
+
+extern "C"
+{
+void* __libc_malloc(std::size_t size);
+void* __libc_calloc(std::size_t count, std::size_t size);
+void* __libc_realloc(void* pointer, std::size_t size);
+void* __libc_memalign(std::size_t alignment, std::size_t size);
+void __libc_free(void* pointer);
+}
+
+namespace
+{
+RtCheckSite sites[rtCheckMaxSites];
+int numSites = 0;
+std::int64_t totalViolations = 0;
+std::int64_t droppedSites = 0;
+std::atomic_flag sitesLock = ATOMIC_FLAG_INIT;
+
+// Static TLS so that touching these never allocates.
+__thread bool inProcessBlock __attribute__((tls_model("initial-exec"))) = false;
+__thread bool inHook __attribute__((tls_model("initial-exec"))) = false;
+__thread std::int64_t currentBlock __attribute__((tls_model("initial-exec"))) = 0;
+
+// The first mutex locked in the current block and the site it was recorded
+// at, or -1 once another lock follows its release.
+__thread pthread_mutex_t* outerMutex __attribute__((tls_model("initial-exec"))) = nullptr;
+__thread int outerSite __attribute__((tls_model("initial-exec"))) = -1;
+__thread bool outerReleased __attribute__((tls_model("initial-exec"))) = false;
+
+using MutexFn = int (*)(pthread_mutex_t*);
+std::atomic<MutexFn> realMutexLock { nullptr };
+std::atomic<MutexFn> realMutexUnlock { nullptr };
+
+struct SpinLockGuard
+{
+    SpinLockGuard()
+    {
+        while (sitesLock.test_and_set(std::memory_order_acquire)) {}
+    }
+
+    ~SpinLockGuard()
+    {
+        sitesLock.clear(std::memory_order_release);
+    }
+};
+
+// Frames belonging to recordViolation and the interposed function itself.
+constexpr int shimFrames = 2;
+
+// Returns the index of the site the call was counted at, or -1.
+__attribute__((noinline)) int recordViolation(int kind, bool contended = false)
+{
+    if (!inProcessBlock || inHook)
+        return -1;
+
+    inHook = true;
+
+    void* frames[rtCheckMaxFrames + shimFrames];
+    const int captured = backtrace(frames, rtCheckMaxFrames + shimFrames);
+    const int numFrames = captured > shimFrames ? captured - shimFrames : 0;
+    void* const* stack = frames + (captured - numFrames);
+    int siteIndex = -1;
+
+    {
+        const SpinLockGuard lock;
+        ++totalViolations;
+
+        bool found = false;
+        for (int i = 0; i < numSites && !found; ++i)
+        {
+            auto& site = sites[i];
+            if (site.kind == kind
+                && site.numFrames == numFrames
+                && std::memcmp(site.frames, stack, sizeof(void*) * static_cast<std::size_t>(numFrames)) == 0)
+            {
+                ++site.count;
+                site.contendedCount += contended ? 1 : 0;
+                site.lastBlock = currentBlock;
+                siteIndex = i;
+                found = true;
+            }
+        }
+
+        if (!found && numSites < rtCheckMaxSites)
+        {
+            siteIndex = numSites;
+            auto& site = sites[numSites++];
+            site.kind = kind;
+            site.numFrames = numFrames;
+            site.count = 1;
+            site.contendedCount = contended ? 1 : 0;
+            site.outermostCount = 0;
+            site.firstBlock = currentBlock;
+            site.lastBlock = currentBlock;
+            std::memcpy(site.frames, stack, sizeof(void*) * static_cast<std::size_t>(numFrames));
+        }
+        else if (!found)
+        {
+            ++droppedSites;
+        }
+    }
+
+    inHook = false;
+    return siteIndex;
+}
+
+MutexFn getRealMutexFunction(std::atomic<MutexFn>& cache, const char* name)
+{
+    auto function = cache.load(std::memory_order_acquire);
+    if (function == nullptr)
+    {
+        function = reinterpret_cast<MutexFn>(dlsym(RTLD_NEXT, name));
+        cache.store(function, std::memory_order_release);
+    }
+
+    return function;
+}
+
+MutexFn getRealMutexLock() { return getRealMutexFunction(realMutexLock, "pthread_mutex_lock"); }
+MutexFn getRealMutexUnlock() { return getRealMutexFunction(realMutexUnlock, "pthread_mutex_unlock"); }
+
+void noteMutexLocked(pthread_mutex_t* mutex, int siteIndex)
+{
+    if (outerMutex == nullptr)
+    {
+        outerMutex = mutex;
+        outerSite = siteIndex;
+    }
+    else if (outerReleased)
+    {
+        outerSite = -1;
+    }
+}
+
+void* allocateForNew(std::size_t size, int kind)
+{
+    recordViolation(kind);
+    if (auto* pointer = __libc_malloc(size != 0 ? size : 1))
+        return pointer;
+
+    throw std::bad_alloc();
+}
+
+void* allocateAlignedForNew(std::size_t size, std::align_val_t alignment, int kind)
+{
+    recordViolation(kind);
+    if (auto* pointer = __libc_memalign(static_cast<std::size_t>(alignment), size != 0 ? size : 1))
+        return pointer;
+
+    throw std::bad_alloc();
+}
+
+void freeForDelete(void* pointer)
+{
+    if (pointer != nullptr)
+        recordViolation(rtCheckOperatorDelete);
+
+    __libc_free(pointer);
+}
+
+__attribute__((constructor)) void initialiseShim()
+{
+    // backtrace() loads its unwinder lazily, which allocates. Do that now,
+    // outside any processBlock region, and resolve the real mutex function.
+    void* frame = nullptr;
+    backtrace(&frame, 1);
+    getRealMutexLock();
+    getRealMutexUnlock();
+}
+} // namespace
+
+extern "C"
+{
+__attribute__((visibility("default"))) void vst3_harness_rtcheck_begin(std::int64_t blockIndex)
+{
+    currentBlock = blockIndex;
+    outerMutex = nullptr;
+    outerSite = -1;
+    outerReleased = false;
+    inProcessBlock = true;
+}
+
+__attribute__((visibility("default"))) void vst3_harness_rtcheck_end()
+{
+    inProcessBlock = false;
+
+    if (outerSite >= 0)
+    {
+        const SpinLockGuard lock;
+        ++sites[outerSite].outermostCount;
+    }
+}
+
+__attribute__((visibility("default"))) int vst3_harness_rtcheck_get_sites(RtCheckSite* destSites,
+                                                                          int maxDestSites,
+                                                                          std::int64_t* outTotalViolations,
+                                                                          std::int64_t* outDroppedSites)
+{
+    const SpinLockGuard lock;
+    const int numCopied = numSites < maxDestSites ? numSites : maxDestSites;
+
+    if (destSites != nullptr && numCopied > 0)
+        std::memcpy(destSites, sites, sizeof(RtCheckSite) * static_cast<std::size_t>(numCopied));
+
+    if (outTotalViolations != nullptr)
+        *outTotalViolations = totalViolations;
+
+    if (outDroppedSites != nullptr)
+        *outDroppedSites = droppedSites + (numSites - numCopied);
+
+    return numCopied;
+}
+
+__attribute__((visibility("default"))) void* malloc(std::size_t size) noexcept
+{
+    recordViolation(rtCheckMalloc);
+    return __libc_malloc(size);
+}
+
+__attribute__((visibility("default"))) void* calloc(std::size_t count, std::size_t size) noexcept
+{
+    recordViolation(rtCheckCalloc);
+    return __libc_calloc(count, size);
+}
+
+__attribute__((visibility("default"))) void* realloc(void* pointer, std::size_t size) noexcept
+{
+    recordViolation(rtCheckRealloc);
+    return __libc_realloc(pointer, size);
+}
+
+__attribute__((visibility("default"))) void* memalign(std::size_t alignment, std::size_t size) noexcept
+{
+    recordViolation(rtCheckAlignedAlloc);
+    return __libc_memalign(alignment, size);
+}
+
+__attribute__((visibility("default"))) void* aligned_alloc(std::size_t alignment, std::size_t size) noexcept
+{
+    recordViolation(rtCheckAlignedAlloc);
+    return __libc_memalign(alignment, size);
+}
+
+__attribute__((visibility("default"))) int posix_memalign(void** result, std::size_t alignment, std::size_t size) noexcept
+{
+    recordViolation(rtCheckAlignedAlloc);
+
+    if (alignment == 0 || alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0)
+        return EINVAL;
+
+    auto* pointer = __libc_memalign(alignment, size);
+    if (pointer == nullptr)
+        return ENOMEM;
+
+    *result = pointer;
+    return 0;
+}
+
+__attribute__((visibility("default"))) void free(void* pointer) noexcept
+{
+    if (pointer != nullptr)
+        recordViolation(rtCheckFree);
+
+    __libc_free(pointer);
+}
+
+__attribute__((visibility("default"))) int pthread_mutex_lock(pthread_mutex_t* mutex) noexcept
+{
+    if (!inProcessBlock || inHook)
+        return getRealMutexLock()(mutex);
+
+    // trylock only tells whether the call would have waited; the lock is
+    // recorded either way.
+    const int result = pthread_mutex_trylock(mutex);
+    const bool contended = result == EBUSY;
+    noteMutexLocked(mutex, recordViolation(rtCheckMutexLock, contended));
+
+    return contended ? getRealMutexLock()(mutex) : result;
+}
+
+__attribute__((visibility("default"))) int pthread_mutex_unlock(pthread_mutex_t* mutex) noexcept
+{
+    if (inProcessBlock && !inHook && mutex == outerMutex)
+        outerReleased = true;
+
+    return getRealMutexUnlock()(mutex);
+}
+} // extern "C"
+
+void* operator new(std::size_t size) { return allocateForNew(size, rtCheckOperatorNew); }
+void* operator new[](std::size_t size) { return allocateForNew(size, rtCheckOperatorNew); }
+void* operator new(std::size_t size, std::align_val_t alignment) { return allocateAlignedForNew(size, alignment, rtCheckOperatorNew); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return allocateAlignedForNew(size, alignment, rtCheckOperatorNew); }
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    recordViolation(rtCheckOperatorNew);
+    return __libc_malloc(size != 0 ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    recordViolation(rtCheckOperatorNew);
+    return __libc_malloc(size != 0 ? size : 1);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    recordViolation(rtCheckOperatorNew);
+    return __libc_memalign(static_cast<std::size_t>(alignment), size != 0 ? size : 1);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    recordViolation(rtCheckOperatorNew);
+    return __libc_memalign(static_cast<std::size_t>(alignment), size != 0 ? size : 1);
+}
+
+void operator delete(void* pointer) noexcept { freeForDelete(pointer); }
+void operator delete[](void* pointer) noexcept { freeForDelete(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { freeForDelete(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept { freeForDelete(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { freeForDelete(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { freeForDelete(pointer); }
+void operator delete(void* pointer, std::align_val_t) noexcept { freeForDelete(pointer); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { freeForDelete(pointer); }
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept { freeForDelete(pointer); }
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept { freeForDelete(pointer); }
+void operator delete(void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { freeForDelete(pointer); }
+void operator delete[](void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { freeForDelete(pointer); }